@@ -0,0 +1,20 @@
+#ifndef CACHE_H
+#define CACHE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "simulator.h"
+
+// A cached simulation result
+typedef struct {
+    uint64_t instruction_count;           // Instructions executed
+    uint32_t exit_reason;                 // Why the run stopped (EXIT_*)
+    uint32_t output[NUM_REGISTERS];       // Register dump as written by write_output_binary()
+} cache_result;
+
+// Function declarations
+uint64_t cache_key(size_t image_size); // Hash the loaded image, initial state and engine version
+int cache_lookup(const char *dir, uint64_t key, cache_result *result); // Returns 1 on a hit
+void cache_store(const char *dir, uint64_t key, const cache_result *result); // Atomically add a result
+
+#endif // CACHE_H
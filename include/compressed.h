@@ -0,0 +1,10 @@
+#ifndef COMPRESSED_H
+#define COMPRESSED_H
+
+#include <stdint.h>
+
+// Function declarations
+int is_compressed(uint16_t halfword); // Check whether a halfword starts a 16-bit instruction
+uint32_t expand_compressed(uint16_t instruction); // Expand an RV32C instruction to its 32-bit equivalent (0 if illegal)
+
+#endif // COMPRESSED_H
@@ -0,0 +1,33 @@
+#ifndef FPU_H
+#define FPU_H
+
+#include <stdint.h>
+
+// Constants
+#define NUM_FREGISTERS 32       // Number of floating-point registers (F extension)
+#define CANONICAL_NAN 0x7fc00000 // Quiet NaN produced by every operation that returns a NaN
+
+// Accrued exception flags (fflags, low bits of fcsr)
+#define FFLAG_NX 0x01 // Inexact
+#define FFLAG_UF 0x02 // Underflow
+#define FFLAG_OF 0x04 // Overflow
+#define FFLAG_DZ 0x08 // Divide by zero
+#define FFLAG_NV 0x10 // Invalid operation
+
+// Floating-point CSR numbers
+#define CSR_FFLAGS 0x001
+#define CSR_FRM    0x002
+#define CSR_FCSR   0x003
+
+// Global variables
+extern uint32_t fregisters[NUM_FREGISTERS]; // Floating-point registers, raw IEEE 754 single-precision bits
+extern uint32_t fcsr;                       // frm in bits 7:5, fflags in bits 4:0
+
+// Function declarations
+void init_fpu(); // Clear the FP registers and fcsr
+void execute_fp(uint32_t instruction); // Execute FLW, FSW, FMADD-family and OP-FP instructions
+int read_fp_csr(uint32_t csr, uint32_t *value); // Read fflags/frm/fcsr. Returns 0 for other CSRs
+void write_fp_csr(uint32_t csr, uint32_t value); // Write fflags/frm/fcsr
+void sync_fp_flags(); // Fold pending host exception flags into fflags
+
+#endif // FPU_H
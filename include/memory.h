@@ -2,11 +2,13 @@
 #define MEMORY_H
 
 #include <stdint.h>
+#include <stddef.h>
 // Global memory array
 extern uint8_t memory[];
+extern uint32_t instruction_length; // Size in bytes (2 or 4) of the last fetched instruction
 
 // Function declarations
-void load_instructions(const char *filename); // Load instructions from a binary file
+size_t load_instructions(const char *filename); // Load instructions from a binary file, returns its size
 uint32_t fetch_instruction();                // Fetch the next instruction from memory
 
-#endif // MEMORY_H
\ No newline at end of file
+#endif // MEMORY_H
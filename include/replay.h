@@ -0,0 +1,29 @@
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include <stdint.h>
+
+// Record/replay modes
+#define REPLAY_OFF    0 // Normal run, nondeterministic values come from the host
+#define REPLAY_RECORD 1 // Log every nondeterministic value to the replay log
+#define REPLAY_REPLAY 2 // Take every nondeterministic value from the replay log
+
+// Kinds of nondeterministic events stored in the log
+#define REPLAY_EVENT_TIME  1 // Host timer read (time / timeh CSR)
+
+// Default number of instructions between checkpoints written while recording
+#define REPLAY_CHECKPOINT_INTERVAL 10000000
+
+extern int replay_mode;
+extern int replay_diverged; // Set once a replayed run stops matching its log
+extern int replay_used;     // Set once the run has read a nondeterministic value
+extern uint64_t replay_checkpoint_interval; // Instructions between checkpoints, 0 disables them
+
+// Function declarations
+void replay_open(const char *filename, int mode, uint64_t image_hash); // Open the log for recording or replaying
+uint32_t replay_event(uint32_t kind, uint32_t host_value); // Record or replay one nondeterministic value
+void replay_checkpoint(); // While recording, save the machine state when a checkpoint is due
+void replay_restore_checkpoint(uint64_t target); // Resume from the latest checkpoint at or before target
+void replay_close(); // Write or check the end-of-run marker and close the log
+
+#endif // REPLAY_H
@@ -8,15 +8,33 @@
 #define NUM_REGISTERS 32 // Number of registers in the RISC-V architecture
 #define MEMORY_SIZE (1024 * 1024) // 1 MB of memory
 
+// Semantic version of the execution engine. Bump it whenever a change can alter
+// the result of a guest program, so cached results from older builds are not reused
+#define ENGINE_VERSION 2
+
+// Why the simulation stopped
+#define EXIT_NONE 0              // Still running
+#define EXIT_ECALL 1             // Guest executed ECALL
+#define EXIT_PC_OUT_OF_BOUNDS 2  // PC left simulated memory
+#define EXIT_HALTED 3            // Simulator halted on an error
+
 extern int running;
+extern int trace_enabled; // Per-instruction trace output on/off, see --trace-from/--trace-to
+
+// Per-instruction trace output. Errors are always printed with plain printf
+#define TRACE(...) do { if (trace_enabled) printf(__VA_ARGS__); } while (0)
+extern int exit_reason;
 
 // Global variables
 extern uint32_t registers[NUM_REGISTERS]; // General-purpose registers
 extern uint32_t PC;                       // Program counter
+extern uint64_t instruction_count;        // Number of instructions executed so far
 
 // Function declarations
 void init_simulator();   // Initialize registers and PC
 void print_registers();  // Print the state of all registers
+void output_register_values(uint32_t values[NUM_REGISTERS]); // Register values as written to the output file
+void write_register_values(const char *filename, const uint32_t values[NUM_REGISTERS]); // Write a register dump
 void write_output_binary(const char *filename); // Write register contents to a binary file
 
-#endif // SIMULATOR_H
\ No newline at end of file
+#endif // SIMULATOR_H
@@ -0,0 +1,101 @@
+#define _POSIX_C_SOURCE 200809L // getpid()
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include "cache.h"
+#include "memory.h"
+#include "simulator.h"
+
+#define CACHE_MAGIC "RVRC"
+
+// On-disk layout of one cache entry
+typedef struct {
+    char magic[4];
+    uint32_t engine_version;
+    uint64_t key;
+    cache_result result;
+} cache_entry;
+
+// 64-bit FNV-1a over a block of bytes
+static uint64_t fnv1a(uint64_t hash, const void *data, size_t size) {
+    const uint8_t *bytes = data;
+    for (size_t i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+// Hash everything the result depends on: engine version, program image and initial state
+uint64_t cache_key(size_t image_size) {
+    uint32_t version = ENGINE_VERSION;
+    uint64_t size = image_size;
+    uint64_t hash = 0xcbf29ce484222325ULL;
+
+    hash = fnv1a(hash, &version, sizeof(version));
+    hash = fnv1a(hash, &size, sizeof(size));
+    hash = fnv1a(hash, memory, image_size);
+    hash = fnv1a(hash, registers, sizeof(uint32_t) * NUM_REGISTERS);
+    hash = fnv1a(hash, &PC, sizeof(PC));
+    return hash;
+}
+
+static void entry_path(char *path, size_t size, const char *dir, uint64_t key) {
+    snprintf(path, size, "%s/%016llx.res", dir, (unsigned long long)key);
+}
+
+// Look up a result. Missing, truncated or stale entries are all treated as misses
+int cache_lookup(const char *dir, uint64_t key, cache_result *result) {
+    char path[4096];
+    entry_path(path, sizeof(path), dir, key);
+
+    FILE *file = fopen(path, "rb");
+    if (!file) {
+        return 0;
+    }
+    cache_entry entry;
+    size_t read = fread(&entry, sizeof(cache_entry), 1, file);
+    fclose(file);
+
+    if (read != 1 || memcmp(entry.magic, CACHE_MAGIC, 4) != 0 ||
+        entry.engine_version != ENGINE_VERSION || entry.key != key) {
+        return 0;
+    }
+    *result = entry.result;
+    return 1;
+}
+
+// Write the entry to a file private to this process, then rename it into place.
+// rename() is atomic, so concurrent runs never see a partial entry and need no lock
+void cache_store(const char *dir, uint64_t key, const cache_result *result) {
+    char path[4096];
+    char tmp_path[4096 + 32];
+    entry_path(path, sizeof(path), dir, key);
+    snprintf(tmp_path, sizeof(tmp_path), "%s.tmp.%ld", path, (long)getpid());
+
+    cache_entry entry;
+    memset(&entry, 0, sizeof(entry));
+    memcpy(entry.magic, CACHE_MAGIC, 4);
+    entry.engine_version = ENGINE_VERSION;
+    entry.key = key;
+    entry.result = *result;
+
+    FILE *file = fopen(tmp_path, "wb");
+    if (!file) {
+        perror("Error opening cache entry");
+        return;
+    }
+    size_t written = fwrite(&entry, sizeof(cache_entry), 1, file);
+    if (fclose(file) != 0 || written != 1) {
+        perror("Error writing cache entry");
+        remove(tmp_path);
+        return;
+    }
+    if (rename(tmp_path, path) != 0) {
+        perror("Error renaming cache entry");
+        remove(tmp_path);
+        return;
+    }
+    printf("Cached result as %s\n", path);
+}
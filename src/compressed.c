@@ -0,0 +1,204 @@
+#include <stdint.h>
+#include "compressed.h"
+
+// Helpers to assemble 32-bit instructions from their fields
+static uint32_t encode_r(uint32_t opcode, uint32_t rd, uint32_t funct3, uint32_t rs1, uint32_t rs2, uint32_t funct7) {
+    return (funct7 << 25) | (rs2 << 20) | (rs1 << 15) | (funct3 << 12) | (rd << 7) | opcode;
+}
+
+static uint32_t encode_i(uint32_t opcode, uint32_t rd, uint32_t funct3, uint32_t rs1, int32_t imm) {
+    return ((uint32_t)imm << 20) | (rs1 << 15) | (funct3 << 12) | (rd << 7) | opcode;
+}
+
+static uint32_t encode_s(uint32_t opcode, uint32_t funct3, uint32_t rs1, uint32_t rs2, int32_t imm) {
+    return (((uint32_t)imm >> 5) << 25) | (rs2 << 20) | (rs1 << 15) | (funct3 << 12) | ((imm & 0x1F) << 7) | opcode;
+}
+
+static uint32_t encode_b(uint32_t funct3, uint32_t rs1, uint32_t rs2, int32_t imm) {
+    uint32_t offset = (uint32_t)imm;
+    return (((offset >> 12) & 0x1) << 31) | (((offset >> 5) & 0x3F) << 25) | (rs2 << 20) | (rs1 << 15)
+         | (funct3 << 12) | (((offset >> 1) & 0xF) << 8) | (((offset >> 11) & 0x1) << 7) | 0x63;
+}
+
+static uint32_t encode_j(uint32_t rd, int32_t imm) {
+    uint32_t offset = (uint32_t)imm;
+    return (((offset >> 20) & 0x1) << 31) | (((offset >> 1) & 0x3FF) << 21) | (((offset >> 11) & 0x1) << 20)
+         | (((offset >> 12) & 0xFF) << 12) | (rd << 7) | 0x6F;
+}
+
+// Sign-extend the low `bits` bits of a value
+static int32_t sext(uint32_t value, int bits) {
+    int32_t shift = 32 - bits;
+    return (int32_t)(value << shift) >> shift;
+}
+
+// Extract bits [hi:lo] of a halfword
+static uint32_t bits(uint16_t instruction, int hi, int lo) {
+    return (instruction >> lo) & ((1u << (hi - lo + 1)) - 1);
+}
+
+// 32-bit instructions have 0b11 in their two lowest bits, everything else is 16-bit
+int is_compressed(uint16_t halfword) {
+    return (halfword & 0x3) != 0x3;
+}
+
+// Expand an RV32C instruction to the 32-bit instruction it stands for
+uint32_t expand_compressed(uint16_t instruction) {
+    uint32_t quadrant = instruction & 0x3;
+    uint32_t funct3 = bits(instruction, 15, 13);
+    uint32_t rd = bits(instruction, 11, 7);           // Full register fields (CR/CI/CSS formats)
+    uint32_t rs2 = bits(instruction, 6, 2);
+    uint32_t rd_prime = bits(instruction, 4, 2) + 8;  // Compressed register fields (x8-x15)
+    uint32_t rs1_prime = bits(instruction, 9, 7) + 8;
+    int32_t imm6 = sext((bits(instruction, 12, 12) << 5) | bits(instruction, 6, 2), 6);
+
+    switch (quadrant) {
+        case 0x0:
+            switch (funct3) {
+                case 0x0: { // C.ADDI4SPN -> addi rd', x2, nzuimm
+                    uint32_t imm = (bits(instruction, 12, 11) << 4) | (bits(instruction, 10, 7) << 6)
+                                 | (bits(instruction, 6, 6) << 2) | (bits(instruction, 5, 5) << 3);
+                    if (imm == 0) {
+                        break;
+                    }
+                    return encode_i(0x13, rd_prime, 0x0, 2, imm);
+                }
+                case 0x2: { // C.LW -> lw rd', uimm(rs1')
+                    uint32_t imm = (bits(instruction, 12, 10) << 3) | (bits(instruction, 6, 6) << 2)
+                                 | (bits(instruction, 5, 5) << 6);
+                    return encode_i(0x03, rd_prime, 0x2, rs1_prime, imm);
+                }
+                case 0x3: { // C.FLW -> flw rd', uimm(rs1')
+                    uint32_t imm = (bits(instruction, 12, 10) << 3) | (bits(instruction, 6, 6) << 2)
+                                 | (bits(instruction, 5, 5) << 6);
+                    return encode_i(0x07, rd_prime, 0x2, rs1_prime, imm);
+                }
+                case 0x6: { // C.SW -> sw rs2', uimm(rs1')
+                    uint32_t imm = (bits(instruction, 12, 10) << 3) | (bits(instruction, 6, 6) << 2)
+                                 | (bits(instruction, 5, 5) << 6);
+                    return encode_s(0x23, 0x2, rs1_prime, rd_prime, imm);
+                }
+                case 0x7: { // C.FSW -> fsw rs2', uimm(rs1')
+                    uint32_t imm = (bits(instruction, 12, 10) << 3) | (bits(instruction, 6, 6) << 2)
+                                 | (bits(instruction, 5, 5) << 6);
+                    return encode_s(0x27, 0x2, rs1_prime, rd_prime, imm);
+                }
+            }
+            break;
+
+        case 0x1:
+            switch (funct3) {
+                case 0x0: // C.ADDI / C.NOP -> addi rd, rd, imm
+                    return encode_i(0x13, rd, 0x0, rd, imm6);
+                case 0x1: // C.JAL -> jal x1, offset
+                case 0x5: { // C.J -> jal x0, offset
+                    int32_t imm = sext((bits(instruction, 12, 12) << 11) | (bits(instruction, 11, 11) << 4)
+                                     | (bits(instruction, 10, 9) << 8) | (bits(instruction, 8, 8) << 10)
+                                     | (bits(instruction, 7, 7) << 6) | (bits(instruction, 6, 6) << 7)
+                                     | (bits(instruction, 5, 3) << 1) | (bits(instruction, 2, 2) << 5), 12);
+                    return encode_j(funct3 == 0x1 ? 1 : 0, imm);
+                }
+                case 0x2: // C.LI -> addi rd, x0, imm
+                    return encode_i(0x13, rd, 0x0, 0, imm6);
+                case 0x3:
+                    if (rd == 2) { // C.ADDI16SP -> addi x2, x2, nzimm
+                        int32_t imm = sext((bits(instruction, 12, 12) << 9) | (bits(instruction, 6, 6) << 4)
+                                         | (bits(instruction, 5, 5) << 6) | (bits(instruction, 4, 3) << 7)
+                                         | (bits(instruction, 2, 2) << 5), 10);
+                        if (imm == 0) {
+                            break;
+                        }
+                        return encode_i(0x13, 2, 0x0, 2, imm);
+                    }
+                    if (imm6 == 0) {
+                        break;
+                    }
+                    return ((uint32_t)imm6 << 12) | (rd << 7) | 0x37; // C.LUI -> lui rd, nzimm
+                case 0x4: {
+                    uint32_t shamt = bits(instruction, 6, 2);
+                    switch (bits(instruction, 11, 10)) {
+                        case 0x0: // C.SRLI -> srli rd', rd', shamt
+                            if (bits(instruction, 12, 12)) {
+                                break; // shamt[5] must be zero on RV32
+                            }
+                            return encode_i(0x13, rs1_prime, 0x5, rs1_prime, shamt);
+                        case 0x1: // C.SRAI -> srai rd', rd', shamt
+                            if (bits(instruction, 12, 12)) {
+                                break;
+                            }
+                            return encode_i(0x13, rs1_prime, 0x5, rs1_prime, 0x400 | shamt);
+                        case 0x2: // C.ANDI -> andi rd', rd', imm
+                            return encode_i(0x13, rs1_prime, 0x7, rs1_prime, imm6);
+                        case 0x3: {
+                            if (bits(instruction, 12, 12)) {
+                                break; // C.SUBW/C.ADDW are RV64 only
+                            }
+                            // C.SUB, C.XOR, C.OR, C.AND -> op rd', rd', rs2'
+                            static const uint32_t funct3s[4] = {0x0, 0x4, 0x6, 0x7};
+                            uint32_t op = bits(instruction, 6, 5);
+                            return encode_r(0x33, rs1_prime, funct3s[op], rs1_prime, rd_prime, op == 0 ? 0x20 : 0x00);
+                        }
+                    }
+                    break;
+                }
+                case 0x6: // C.BEQZ -> beq rs1', x0, offset
+                case 0x7: { // C.BNEZ -> bne rs1', x0, offset
+                    int32_t imm = sext((bits(instruction, 12, 12) << 8) | (bits(instruction, 11, 10) << 3)
+                                     | (bits(instruction, 6, 5) << 6) | (bits(instruction, 4, 3) << 1)
+                                     | (bits(instruction, 2, 2) << 5), 9);
+                    return encode_b(funct3 == 0x6 ? 0x0 : 0x1, rs1_prime, 0, imm);
+                }
+            }
+            break;
+
+        case 0x2:
+            switch (funct3) {
+                case 0x0: // C.SLLI -> slli rd, rd, shamt
+                    if (bits(instruction, 12, 12)) {
+                        break;
+                    }
+                    return encode_i(0x13, rd, 0x1, rd, bits(instruction, 6, 2));
+                case 0x2: { // C.LWSP -> lw rd, uimm(x2)
+                    uint32_t imm = (bits(instruction, 12, 12) << 5) | (bits(instruction, 6, 4) << 2)
+                                 | (bits(instruction, 3, 2) << 6);
+                    if (rd == 0) {
+                        break;
+                    }
+                    return encode_i(0x03, rd, 0x2, 2, imm);
+                }
+                case 0x3: { // C.FLWSP -> flw rd, uimm(x2)
+                    uint32_t imm = (bits(instruction, 12, 12) << 5) | (bits(instruction, 6, 4) << 2)
+                                 | (bits(instruction, 3, 2) << 6);
+                    return encode_i(0x07, rd, 0x2, 2, imm);
+                }
+                case 0x4:
+                    if (!bits(instruction, 12, 12)) {
+                        if (rs2 == 0) { // C.JR -> jalr x0, 0(rs1)
+                            if (rd == 0) {
+                                break;
+                            }
+                            return encode_i(0x67, 0, 0x0, rd, 0);
+                        }
+                        return encode_r(0x33, rd, 0x0, 0, rs2, 0x00); // C.MV -> add rd, x0, rs2
+                    }
+                    if (rd == 0 && rs2 == 0) { // C.EBREAK
+                        return 0x00100073;
+                    }
+                    if (rs2 == 0) { // C.JALR -> jalr x1, 0(rs1)
+                        return encode_i(0x67, 1, 0x0, rd, 0);
+                    }
+                    return encode_r(0x33, rd, 0x0, rd, rs2, 0x00); // C.ADD -> add rd, rd, rs2
+                case 0x6: { // C.SWSP -> sw rs2, uimm(x2)
+                    uint32_t imm = (bits(instruction, 12, 9) << 2) | (bits(instruction, 8, 7) << 6);
+                    return encode_s(0x23, 0x2, 2, rs2, imm);
+                }
+                case 0x7: { // C.FSWSP -> fsw rs2, uimm(x2)
+                    uint32_t imm = (bits(instruction, 12, 9) << 2) | (bits(instruction, 8, 7) << 6);
+                    return encode_s(0x27, 0x2, 2, rs2, imm);
+                }
+            }
+            break;
+    }
+
+    return 0; // Reserved or illegal encoding, the caller reports it
+}
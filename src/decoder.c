@@ -1,23 +1,55 @@
 #include <stdio.h>
 #include <stdint.h>
+#include <time.h>
 #include "../include/simulator.h"
 #include "../include/memory.h"
 #include "../include/decoder.h"
+#include "../include/replay.h"
+#include "../include/fpu.h"
 
 int stack_pointer_used = 0;
 
+// Host wall-clock time in microseconds, the source for the time/timeh CSRs
+static uint64_t host_time_us() {
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+// Read one of the user counter CSRs. Returns 0 if the CSR is not implemented
+static int read_counter_csr(uint32_t csr, uint32_t *value) {
+    switch (csr) {
+        case 0xC00: // cycle (one instruction per cycle)
+        case 0xC02: // instret
+            *value = (uint32_t)instruction_count;
+            return 1;
+        case 0xC80: // cycleh
+        case 0xC82: // instreth
+            *value = (uint32_t)(instruction_count >> 32);
+            return 1;
+        case 0xC01: // time, nondeterministic so it goes through the replay log
+            *value = replay_event(REPLAY_EVENT_TIME, (uint32_t)host_time_us());
+            return 1;
+        case 0xC81: // timeh
+            *value = replay_event(REPLAY_EVENT_TIME, (uint32_t)(host_time_us() >> 32));
+            return 1;
+        default:
+            return 0;
+    }
+}
+
 // Decode and execute a single instruction
 void decode_and_execute(uint32_t instruction) {
     uint32_t opcode = instruction & 0x7F;
-    printf("PC: 0x%x, Instruction: 0x%x\n", PC, instruction);
-    printf("Extracted opcode: 0x%x\n", opcode);
+    TRACE("PC: 0x%x, Instruction: 0x%x\n", PC, instruction);
+    TRACE("Extracted opcode: 0x%x\n", opcode);
 
     switch (opcode) {
         case 0x03: { // Load Instructions (LB, LH, LW, LBU, LHU)
             uint32_t rd = (instruction >> 7) & 0x1F;
             uint32_t rs1 = (instruction >> 15) & 0x1F;
             if (rd == 0) {
-                printf("Ignoring write to x0 (zero register)\n");
+                TRACE("Ignoring write to x0 (zero register)\n");
                 return;
             }
             int32_t imm = sign_extend((instruction >> 20), 12); // Sign-extend the 12-bit immediate value
@@ -27,15 +59,15 @@ void decode_and_execute(uint32_t instruction) {
             // Check if using Stack Pointer (sp)
             if (rs1 == 2) {
                 stack_pointer_used = 1;
-                printf("Load using Stack Pointer (x2): Loading from address 0x%x\n", address);
+                TRACE("Load using Stack Pointer (x2): Loading from address 0x%x\n", address);
             }
             if (rd == 2) {
                 stack_pointer_used = 1;
-                printf("Load instruction overwrites stack pointer (x2) -> x2 = 0x%x\n", registers[rd]);
+                TRACE("Load instruction overwrites stack pointer (x2) -> x2 = 0x%x\n", registers[rd]);
             }
             // Alignment check for word loads
             if ((funct3 == 0x2) && (address % 4 != 0)) {
-                printf("Warning: Misaligned memory access for LW at address 0x%x\n", address);
+                TRACE("Warning: Misaligned memory access for LW at address 0x%x\n", address);
 
                 // Handle unaligned access by loading individual bytes and combining them
                 uint32_t byte0 = memory[address];
@@ -48,11 +80,11 @@ void decode_and_execute(uint32_t instruction) {
 
                 // Store the loaded word into the destination register
                 registers[rd] = loaded_word;
-                printf("LW (unaligned): Loaded word 0x%x from memory address 0x%x\n", loaded_word, address);
+                TRACE("LW (unaligned): Loaded word 0x%x from memory address 0x%x\n", loaded_word, address);
             } else if (funct3 == 0x2) {
                 // Aligned access
                 registers[rd] = *((uint32_t *)(memory + address));
-                printf("LW: Loaded word 0x%x from memory address 0x%x\n", registers[rd], address);
+                TRACE("LW: Loaded word 0x%x from memory address 0x%x\n", registers[rd], address);
             }
 
 
@@ -60,18 +92,18 @@ void decode_and_execute(uint32_t instruction) {
                 case 0x0: { // LB (Load Byte, sign-extended)
                     int8_t value = *((int8_t *)(memory + address));
                     registers[rd] = (int32_t)value;
-                    printf("LB x%d, %d(x%d) -> x%d = 0x%x\n", rd, imm, rs1, rd, registers[rd]);
+                    TRACE("LB x%d, %d(x%d) -> x%d = 0x%x\n", rd, imm, rs1, rd, registers[rd]);
                     break;
                 }
                 case 0x1: { // LH (Load Halfword, sign-extended)
                     int16_t value = *((int16_t *)(memory + address));
                     registers[rd] = (int32_t)value;
-                    printf("LH x%d, %d(x%d) -> x%d = 0x%x\n", rd, imm, rs1, rd, registers[rd]);
+                    TRACE("LH x%d, %d(x%d) -> x%d = 0x%x\n", rd, imm, rs1, rd, registers[rd]);
                     break;
                 }
                 case 0x2: { // LW (Load Word)
                     if (address % 4 != 0) {
-                        printf("Warning: Misaligned memory access for LW at address 0x%x\n", address);
+                        TRACE("Warning: Misaligned memory access for LW at address 0x%x\n", address);
 
                         // Load individual bytes and combine them correctly in little-endian order
                         uint32_t byte0 = (uint32_t)memory[address];
@@ -84,11 +116,11 @@ void decode_and_execute(uint32_t instruction) {
 
                         // Store the loaded word into the destination register
                         registers[rd] = loaded_word;
-                        printf("LW (unaligned): Loaded word 0x%x from memory address 0x%x\n", loaded_word, address);
+                        TRACE("LW (unaligned): Loaded word 0x%x from memory address 0x%x\n", loaded_word, address);
                     } else {
                         // Aligned access
                         registers[rd] = *((uint32_t *)(memory + address));
-                        printf("LW: Loaded word 0x%x from memory address 0x%x\n", registers[rd], address);
+                        TRACE("LW: Loaded word 0x%x from memory address 0x%x\n", registers[rd], address);
                     }
                     break;
                 }
@@ -96,13 +128,13 @@ void decode_and_execute(uint32_t instruction) {
                 case 0x4: { // LBU (Load Byte Unsigned)
                     uint8_t value = *((uint8_t *)(memory + address));
                     registers[rd] = (uint32_t)value;
-                    printf("LBU x%d, %d(x%d) -> x%d = 0x%x\n", rd, imm, rs1, rd, registers[rd]);
+                    TRACE("LBU x%d, %d(x%d) -> x%d = 0x%x\n", rd, imm, rs1, rd, registers[rd]);
                     break;
                 }
                 case 0x5: { // LHU (Load Halfword Unsigned)
                     uint16_t value = *((uint16_t *)(memory + address));
                     registers[rd] = (uint32_t)value;
-                    printf("LHU x%d, %d(x%d) -> x%d = 0x%x\n", rd, imm, rs1, rd, registers[rd]);
+                    TRACE("LHU x%d, %d(x%d) -> x%d = 0x%x\n", rd, imm, rs1, rd, registers[rd]);
                     break;
                 }
                 default:
@@ -122,7 +154,7 @@ void decode_and_execute(uint32_t instruction) {
         case 0x13: { // I-Type Instructions (ADDI, SLTI, SLTIU, XORI, ORI, ANDI)
             uint32_t rd = (instruction >> 7) & 0x1F;
             if (rd == 0) {
-                printf("Ignoring write to x0 (zero register)\n");
+                TRACE("Ignoring write to x0 (zero register)\n");
                 return;
             }
             uint32_t rs1 = (instruction >> 15) & 0x1F;
@@ -135,16 +167,16 @@ void decode_and_execute(uint32_t instruction) {
 
             switch (funct3) {
                 case 0x0: // ADDI
-                    printf("ADDI: rd = x%d, rs1 = x%d, imm = %d\n", rd, rs1, imm);
-                    printf("Before ADDI: registers[%d] = %d, registers[%d] = %d\n", rd, registers[rd], rs1, registers[rs1]);
+                    TRACE("ADDI: rd = x%d, rs1 = x%d, imm = %d\n", rd, rs1, imm);
+                    TRACE("Before ADDI: registers[%d] = %d, registers[%d] = %d\n", rd, registers[rd], rs1, registers[rs1]);
 
                     // Perform the addition
                     registers[rd] = registers[rs1] + imm;
 
                     // Check if the destination is the stack pointer (sp)
                     if (rd == 2) {
-                        printf("Stack Pointer Adjustment: sp = sp + %d\n", imm);
-                        printf("After ADDI: registers[%d] (sp) = 0x%x\n", rd, registers[rd]);
+                        TRACE("Stack Pointer Adjustment: sp = sp + %d\n", imm);
+                        TRACE("After ADDI: registers[%d] (sp) = 0x%x\n", rd, registers[rd]);
                         stack_pointer_used = 1;
                         // Check for stack alignment after adjustment
                         if (registers[2] % 16 != 0) {
@@ -153,41 +185,41 @@ void decode_and_execute(uint32_t instruction) {
                             return;
                         }
                     } else {
-                        printf("After ADDI: registers[%d] = %d\n", rd, registers[rd]);
+                        TRACE("After ADDI: registers[%d] = %d\n", rd, registers[rd]);
                     }
                     break;
                 case 0x1: // SLLI (Shift Left Logical Immediate)
                     registers[rd] = registers[rs1] << shamt;
-                    printf("SLLI x%d, x%d, %d -> x%d = %d\n", rd, rs1, shamt, rd, registers[rd]);
+                    TRACE("SLLI x%d, x%d, %d -> x%d = %d\n", rd, rs1, shamt, rd, registers[rd]);
                     break;
                 case 0x2: // SLTI (Set Less Than Immediate, signed)
                     registers[rd] = (int32_t)registers[rs1] < imm ? 1 : 0;
-                    printf("SLTI x%d, x%d, %d -> x%d = %d\n", rd, rs1, imm, rd, registers[rd]);
+                    TRACE("SLTI x%d, x%d, %d -> x%d = %d\n", rd, rs1, imm, rd, registers[rd]);
                     break;
                 case 0x3: // SLTIU (Set Less Than Immediate Unsigned)
                     registers[rd] = (uint32_t)registers[rs1] < (uint32_t)imm ? 1 : 0;
-                    printf("SLTIU x%d, x%d, %d -> x%d = %d\n", rd, rs1, imm, rd, registers[rd]);
+                    TRACE("SLTIU x%d, x%d, %d -> x%d = %d\n", rd, rs1, imm, rd, registers[rd]);
                     break;
                 case 0x4: // XORI
                     registers[rd] = registers[rs1] ^ imm;
-                    printf("XORI x%d, x%d, %d -> x%d = %d\n", rd, rs1, imm, rd, registers[rd]);
+                    TRACE("XORI x%d, x%d, %d -> x%d = %d\n", rd, rs1, imm, rd, registers[rd]);
                     break;
                 case 0x5:
                     if (funct7 == 0x00) { // SRLI (Shift Right Logical Immediate)
                         registers[rd] = (uint32_t)registers[rs1] >> shamt;
-                        printf("SRLI x%d, x%d, %d -> x%d = %d\n", rd, rs1, shamt, rd, registers[rd]);
+                        TRACE("SRLI x%d, x%d, %d -> x%d = %d\n", rd, rs1, shamt, rd, registers[rd]);
                     } else if (funct7 == 0x20) { // SRAI (Shift Right Arithmetic Immediate)
                         registers[rd] = (int32_t)registers[rs1] >> shamt;
-                        printf("SRAI x%d, x%d, %d -> x%d = %d\n", rd, rs1, shamt, rd, registers[rd]);
+                        TRACE("SRAI x%d, x%d, %d -> x%d = %d\n", rd, rs1, shamt, rd, registers[rd]);
                     }
                     break;
                 case 0x6: // ORI
                     registers[rd] = registers[rs1] | imm;
-                    printf("ORI x%d, x%d, %d -> x%d = %d\n", rd, rs1, imm, rd, registers[rd]);
+                    TRACE("ORI x%d, x%d, %d -> x%d = %d\n", rd, rs1, imm, rd, registers[rd]);
                     break;
                 case 0x7: // ANDI
                     registers[rd] = registers[rs1] & imm;
-                    printf("ANDI x%d, x%d, %d -> x%d = %d\n", rd, rs1, imm, rd, registers[rd]);
+                    TRACE("ANDI x%d, x%d, %d -> x%d = %d\n", rd, rs1, imm, rd, registers[rd]);
                     break;
                 default:
                     printf("Unknown I-type funct3: 0x%x\n", funct3);
@@ -204,7 +236,7 @@ void decode_and_execute(uint32_t instruction) {
             uint32_t address = registers[rs1] + imm;
 
             if (rs1 == 2) { // Using Stack Pointer (sp)
-                printf("Using Stack Pointer (sp) for address calculation: sp = 0x%x, offset = %d, address = 0x%x\n",
+                TRACE("Using Stack Pointer (sp) for address calculation: sp = 0x%x, offset = %d, address = 0x%x\n",
                     registers[rs1], imm, address);
                 stack_pointer_used = 1;
             }
@@ -220,7 +252,7 @@ void decode_and_execute(uint32_t instruction) {
                 case 0x0: { // SB (Store Byte)
                     uint8_t value = registers[rs2] & 0xFF;
                     memory[address] = value;
-                    printf("SB: Storing byte 0x%x from x%d to memory address 0x%x\n", value, rs2, address);
+                    TRACE("SB: Storing byte 0x%x from x%d to memory address 0x%x\n", value, rs2, address);
                     break;
                 }
                 case 0x1: { // SH (Store Halfword)
@@ -232,13 +264,13 @@ void decode_and_execute(uint32_t instruction) {
                     }
                     uint16_t value = registers[rs2] & 0xFFFF;
                     *((uint16_t *)(memory + address)) = value;
-                    printf("SH: Storing halfword 0x%x from x%d to memory address 0x%x\n", value, rs2, address);
+                    TRACE("SH: Storing halfword 0x%x from x%d to memory address 0x%x\n", value, rs2, address);
                     break;
                 }
                 case 0x2: { // SW (Store Word)
                     // Check if address is aligned to 4 bytes
                     if (address % 4 != 0) {
-                        printf("Warning: Misaligned memory access for SW at address 0x%x\n", address);
+                        TRACE("Warning: Misaligned memory access for SW at address 0x%x\n", address);
 
                         // Handle unaligned access by storing the word in bytes
                         memory[address] = registers[rs2] & 0xFF;
@@ -246,12 +278,12 @@ void decode_and_execute(uint32_t instruction) {
                         memory[address + 2] = (registers[rs2] >> 16) & 0xFF;
                         memory[address + 3] = (registers[rs2] >> 24) & 0xFF;
 
-                        printf("SW (unaligned): Storing word 0x%x from x%d to memory address 0x%x (split into bytes)\n",
+                        TRACE("SW (unaligned): Storing word 0x%x from x%d to memory address 0x%x (split into bytes)\n",
                             registers[rs2], rs2, address);
                     } else {
                         // Aligned access
                         *((uint32_t *)(memory + address)) = registers[rs2];
-                        printf("SW: Storing word 0x%x from x%d to memory address 0x%x\n", registers[rs2], rs2, address);
+                        TRACE("SW: Storing word 0x%x from x%d to memory address 0x%x\n", registers[rs2], rs2, address);
                     }
                     break;
                 }
@@ -266,18 +298,18 @@ void decode_and_execute(uint32_t instruction) {
             uint32_t rd = (instruction >> 7) & 0x1F;
             int32_t imm = instruction & 0xFFFFF000;
             registers[rd] = imm;
-            printf("LUI x%d, 0x%x -> x%d = 0x%x\n", rd, imm, rd, registers[rd]);
+            TRACE("LUI x%d, 0x%x -> x%d = 0x%x\n", rd, imm, rd, registers[rd]);
             // Check if the destination register is the stack pointer (x2)
             if (rd == 2) {
                 stack_pointer_used = 1;
-                printf("Stack pointer (sp) initialized by LUI: sp = 0x%x\n", registers[rd]);
+                TRACE("Stack pointer (sp) initialized by LUI: sp = 0x%x\n", registers[rd]);
             }
             break;
         }
         case 0x33: { // R-Type Instructions (e.g., ADD, SUB, SLT, SLTU, XOR, OR, AND)
             uint32_t rd = (instruction >> 7) & 0x1F;
             if (rd == 0) {
-                printf("Ignoring write to x0 (zero register)\n");
+                TRACE("Ignoring write to x0 (zero register)\n");
                 return;
             }
             uint32_t rs1 = (instruction >> 15) & 0x1F;
@@ -289,48 +321,48 @@ void decode_and_execute(uint32_t instruction) {
                 case 0x0: // ADD or SUB
                     if (funct7 == 0x00) { // ADD
                         registers[rd] = registers[rs1] + registers[rs2];
-                        printf("ADD x%d, x%d, x%d -> x%d = %d\n", rd, rs1, rs2, rd, registers[rd]);
+                        TRACE("ADD x%d, x%d, x%d -> x%d = %d\n", rd, rs1, rs2, rd, registers[rd]);
                     } else if (funct7 == 0x20) { // SUB
                         registers[rd] = registers[rs1] - registers[rs2];
-                        printf("SUB x%d, x%d, x%d -> x%d = %d\n", rd, rs1, rs2, rd, registers[rd]);
+                        TRACE("SUB x%d, x%d, x%d -> x%d = %d\n", rd, rs1, rs2, rd, registers[rd]);
                     }
                     if (rd == 2) {
                         stack_pointer_used = 1;
-                        printf("Stack pointer (x2) modified by R-Type instruction.\n");
+                        TRACE("Stack pointer (x2) modified by R-Type instruction.\n");
                     }
                     break;
                 case 0x1: // SLL (Shift Left Logical)
                     registers[rd] = registers[rs1] << (registers[rs2] & 0x1F);
-                    printf("SLL x%d, x%d, x%d -> x%d = %d\n", rd, rs1, rs2, rd, registers[rd]);
+                    TRACE("SLL x%d, x%d, x%d -> x%d = %d\n", rd, rs1, rs2, rd, registers[rd]);
                     break;
                 case 0x2: // SLT (Set Less Than, signed)
                     registers[rd] = (int32_t)registers[rs1] < (int32_t)registers[rs2] ? 1 : 0;
-                    printf("SLT x%d, x%d, x%d -> x%d = %d\n", rd, rs1, rs2, rd, registers[rd]);
+                    TRACE("SLT x%d, x%d, x%d -> x%d = %d\n", rd, rs1, rs2, rd, registers[rd]);
                     break;
                 case 0x3: // SLTU (Set Less Than Unsigned)
                     registers[rd] = (uint32_t)registers[rs1] < (uint32_t)registers[rs2] ? 1 : 0;
-                    printf("SLTU x%d, x%d, x%d -> x%d = %d\n", rd, rs1, rs2, rd, registers[rd]);
+                    TRACE("SLTU x%d, x%d, x%d -> x%d = %d\n", rd, rs1, rs2, rd, registers[rd]);
                     break;
                 case 0x4: // XOR
                     registers[rd] = registers[rs1] ^ registers[rs2];
-                    printf("XOR x%d, x%d, x%d -> x%d = %d\n", rd, rs1, rs2, rd, registers[rd]);
+                    TRACE("XOR x%d, x%d, x%d -> x%d = %d\n", rd, rs1, rs2, rd, registers[rd]);
                     break;
                 case 0x5:
                     if (funct7 == 0x00) { // SRL (Shift Right Logical)
                         registers[rd] = (uint32_t)registers[rs1] >> (registers[rs2] & 0x1F);
-                        printf("SRL x%d, x%d, x%d -> x%d = %d\n", rd, rs1, rs2, rd, registers[rd]);
+                        TRACE("SRL x%d, x%d, x%d -> x%d = %d\n", rd, rs1, rs2, rd, registers[rd]);
                     } else if (funct7 == 0x20) { // SRA (Shift Right Arithmetic)
                         registers[rd] = (int32_t)registers[rs1] >> (registers[rs2] & 0x1F);
-                        printf("SRA x%d, x%d, x%d -> x%d = %d\n", rd, rs1, rs2, rd, registers[rd]);
+                        TRACE("SRA x%d, x%d, x%d -> x%d = %d\n", rd, rs1, rs2, rd, registers[rd]);
                     }
                     break;
                 case 0x6: // OR
                     registers[rd] = registers[rs1] | registers[rs2];
-                    printf("OR x%d, x%d, x%d -> x%d = %d\n", rd, rs1, rs2, rd, registers[rd]);
+                    TRACE("OR x%d, x%d, x%d -> x%d = %d\n", rd, rs1, rs2, rd, registers[rd]);
                     break;
                 case 0x7: // AND
                     registers[rd] = registers[rs1] & registers[rs2];
-                    printf("AND x%d, x%d, x%d -> x%d = %d\n", rd, rs1, rs2, rd, registers[rd]);
+                    TRACE("AND x%d, x%d, x%d -> x%d = %d\n", rd, rs1, rs2, rd, registers[rd]);
                     break;
                 default:
                     printf("Unknown R-type funct3: 0x%x\n", funct3);
@@ -354,49 +386,49 @@ void decode_and_execute(uint32_t instruction) {
                 case 0x0: // BEQ
                     if (registers[rs1] == registers[rs2]) {
                         PC += imm;
-                        printf("BEQ x%d, x%d, offset %d -> PC = 0x%x\n", rs1, rs2, imm, PC);
+                        TRACE("BEQ x%d, x%d, offset %d -> PC = 0x%x\n", rs1, rs2, imm, PC);
                         return;
                     }
                     break;
                 case 0x1: // BNE
                     if (registers[rs1] != registers[rs2]) {
                         PC += imm;
-                        printf("BNE x%d, x%d, offset %d -> PC = 0x%x\n", rs1, rs2, imm, PC);
+                        TRACE("BNE x%d, x%d, offset %d -> PC = 0x%x\n", rs1, rs2, imm, PC);
                         return;
                     }
                     break;
                 case 0x2: // BGT (Branch if Greater Than)
                     if ((int32_t)registers[rs1] > (int32_t)registers[rs2]) {
                         PC += imm;
-                        printf("BGT x%d, x%d, offset %d -> Branch taken, New PC = 0x%x\n", rs1, rs2, imm, PC);
+                        TRACE("BGT x%d, x%d, offset %d -> Branch taken, New PC = 0x%x\n", rs1, rs2, imm, PC);
                         return;
                     }
                     break;
                 case 0x4: // BLT
                     if ((int32_t)registers[rs1] < (int32_t)registers[rs2]) {
                         PC += imm;
-                        printf("BLT x%d, x%d, offset %d -> PC = 0x%x\n", rs1, rs2, imm, PC);
+                        TRACE("BLT x%d, x%d, offset %d -> PC = 0x%x\n", rs1, rs2, imm, PC);
                         return;
                     }
                     break;
                 case 0x5: // BGE
                     if ((int32_t)registers[rs1] >= (int32_t)registers[rs2]) {
                         PC += imm;
-                        printf("BGE x%d, x%d, offset %d -> PC = 0x%x\n", rs1, rs2, imm, PC);
+                        TRACE("BGE x%d, x%d, offset %d -> PC = 0x%x\n", rs1, rs2, imm, PC);
                         return;
                     }
                     break;
                 case 0x6: // BLTU
                     if ((uint32_t)registers[rs1] < (uint32_t)registers[rs2]) {
                         PC += imm;
-                        printf("BLTU x%d, x%d, offset %d -> PC = 0x%x\n", rs1, rs2, imm, PC);
+                        TRACE("BLTU x%d, x%d, offset %d -> PC = 0x%x\n", rs1, rs2, imm, PC);
                         return;
                     }
                     break;
                 case 0x7: // BGEU
                     if ((uint32_t)registers[rs1] >= (uint32_t)registers[rs2]) {
                         PC += imm;
-                        printf("BGEU x%d, x%d, offset %d -> PC = 0x%x\n", rs1, rs2, imm, PC);
+                        TRACE("BGEU x%d, x%d, offset %d -> PC = 0x%x\n", rs1, rs2, imm, PC);
                         return;
                     }
                     break;
@@ -405,9 +437,9 @@ void decode_and_execute(uint32_t instruction) {
                     break;
             }
 
-            // If branch is not taken, increment PC by 4
-            PC += 4;
-            printf("Branch not taken -> PC incremented to 0x%x\n", PC);
+            // If branch is not taken, move on to the next instruction
+            PC += instruction_length;
+            TRACE("Branch not taken -> PC incremented to 0x%x\n", PC);
             break;
         }
         case 0x6F: { // JAL (Jump and Link)
@@ -420,7 +452,7 @@ void decode_and_execute(uint32_t instruction) {
 
             // Save the return address only if rd is not x0
             if (rd != 0) {
-                registers[rd] = PC + 4;
+                registers[rd] = PC + instruction_length;
             }
 
             // Function call: Allocate space on the stack (16 bytes) and save the return address (ra)
@@ -428,12 +460,12 @@ void decode_and_execute(uint32_t instruction) {
                 registers[2] -= 16; // Adjust stack pointer (sp)
                 *((uint32_t *)(memory + registers[2])) = registers[1]; // Save return address (ra) on the stack
                 stack_pointer_used = 1;
-                printf("JAL (Function Call): Saved ra = 0x%x, Adjusted sp = 0x%x\n", registers[1], registers[2]);
+                TRACE("JAL (Function Call): Saved ra = 0x%x, Adjusted sp = 0x%x\n", registers[1], registers[2]);
             }
 
             // Jump to target address
             PC += imm;
-            printf("JAL x%d, offset %d -> PC = 0x%x, x%d = 0x%x\n", rd, imm, PC, rd, registers[rd]);
+            TRACE("JAL x%d, offset %d -> PC = 0x%x, x%d = 0x%x\n", rd, imm, PC, rd, registers[rd]);
             if (PC >= MEMORY_SIZE) {
                 printf("Error: JAL set PC out of bounds (0x%x). Halting simulation.\n", PC);
                 running = 0;
@@ -450,7 +482,7 @@ void decode_and_execute(uint32_t instruction) {
 
             // Save the return address only if rd is not x0
             if (rd != 0) {
-                registers[rd] = PC + 4;
+                registers[rd] = PC + instruction_length;
             }
 
             // Function return: Restore return address (ra) from the stack and adjust the stack pointer (sp)
@@ -459,13 +491,13 @@ void decode_and_execute(uint32_t instruction) {
                 registers[2] += 16; // Restore the stack pointer (deallocate stack frame)
                 PC = registers[1]; // Jump to the return address (ra)
                 stack_pointer_used = 1;
-                printf("JALR (Return): Restoring ra = 0x%x, sp = 0x%x, Jumping to PC = 0x%x\n", registers[1], registers[2], PC);
+                TRACE("JALR (Return): Restoring ra = 0x%x, sp = 0x%x, Jumping to PC = 0x%x\n", registers[1], registers[2], PC);
                 return;
             }
 
             // Normal JALR: Jump to target address
             PC = target_address;
-            printf("JALR: Jumping to 0x%x, rd (x%d) = 0x%x\n", PC, rd, registers[rd]);
+            TRACE("JALR: Jumping to 0x%x, rd (x%d) = 0x%x\n", PC, rd, registers[rd]);
             if (PC >= MEMORY_SIZE) {
                 printf("Error: JALR set PC out of bounds (0x%x). Halting simulation.\n", PC);
                 running = 0;
@@ -475,10 +507,60 @@ void decode_and_execute(uint32_t instruction) {
         }
 
 
-        case 0x73: { // ECALL
-            printf("ECALL encountered. Exiting simulation.\n");
-            running = 0;
-            return;
+        case 0x07: // FLW
+        case 0x27: // FSW
+        case 0x43: // FMADD.S
+        case 0x47: // FMSUB.S
+        case 0x4B: // FNMSUB.S
+        case 0x4F: // FNMADD.S
+        case 0x53: // OP-FP (arithmetic, conversions, compares and moves)
+            execute_fp(instruction);
+            break;
+
+        case 0x73: { // ECALL and CSR instructions
+            uint32_t funct3 = (instruction >> 12) & 0x07;
+            if (funct3 == 0x0) { // ECALL
+                TRACE("ECALL encountered. Exiting simulation.\n");
+                running = 0;
+                exit_reason = EXIT_ECALL;
+                return;
+            }
+
+            // CSRRW/CSRRS/CSRRC take their source from rs1, the immediate forms use the rs1 field itself.
+            // CSRRS/CSRRC with a zero source only read the CSR
+            uint32_t rd = (instruction >> 7) & 0x1F;
+            uint32_t rs1 = (instruction >> 15) & 0x1F;
+            uint32_t csr = instruction >> 20;
+            uint32_t source = (funct3 & 0x4) ? rs1 : registers[rs1];
+            int writes = (funct3 & 0x3) == 0x1 || rs1 != 0;
+            uint32_t value;
+            if (funct3 == 0x4) {
+                printf("Unknown SYSTEM funct3: 0x%x\n", funct3);
+                running = 0;
+                return;
+            }
+            if (read_fp_csr(csr, &value)) {
+                if (writes) {
+                    switch (funct3 & 0x3) {
+                        case 0x1: write_fp_csr(csr, source); break;          // CSRRW
+                        case 0x2: write_fp_csr(csr, value | source); break;  // CSRRS
+                        case 0x3: write_fp_csr(csr, value & ~source); break; // CSRRC
+                    }
+                }
+            } else if (writes) {
+                printf("Illegal write to read-only or unknown CSR 0x%x\n", csr);
+                running = 0;
+                return;
+            } else if (!read_counter_csr(csr, &value)) {
+                printf("Unknown CSR: 0x%x\n", csr);
+                running = 0;
+                return;
+            }
+            if (rd != 0) {
+                registers[rd] = value;
+            }
+            TRACE("CSR read 0x%x -> x%d = 0x%x\n", csr, rd, value);
+            break;
         }
         default:
             printf("Unknown opcode: 0x%x\n", opcode);
@@ -0,0 +1,537 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <float.h>
+#include <math.h>
+#include <fenv.h>
+#include "fpu.h"
+#include "simulator.h"
+#include "memory.h"
+#include "decoder.h"
+
+uint32_t fregisters[NUM_FREGISTERS] = {0};
+uint32_t fcsr = 0;
+
+// Rounding modes (rm field of the instruction, or frm when rm is DYN)
+#define RM_RNE 0 // Round to nearest, ties to even
+#define RM_RTZ 1 // Round towards zero
+#define RM_RDN 2 // Round down
+#define RM_RUP 3 // Round up
+#define RM_RMM 4 // Round to nearest, ties to max magnitude
+#define RM_DYN 7 // Use frm
+
+#define SIGN_BIT 0x80000000
+
+// Arithmetic operations that round
+#define FP_ADD  0
+#define FP_SUB  1
+#define FP_MUL  2
+#define FP_DIV  3
+#define FP_SQRT 4
+#define FP_FMA  5
+
+// Host rounding modes for RNE, RTZ, RDN and RUP. The host FPU has no RMM
+static const int host_rounding[4] = {FE_TONEAREST, FE_TOWARDZERO, FE_DOWNWARD, FE_UPWARD};
+
+static float to_float(uint32_t bits) {
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+static uint32_t to_bits(float value) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+static int is_nan(uint32_t bits) {
+    return (bits & ~SIGN_BIT) > 0x7f800000;
+}
+
+static int is_snan(uint32_t bits) {
+    return is_nan(bits) && !(bits & 0x00400000);
+}
+
+static int is_inf(uint32_t bits) {
+    return (bits & ~SIGN_BIT) == 0x7f800000;
+}
+
+static int is_zero(uint32_t bits) {
+    return (bits & ~SIGN_BIT) == 0;
+}
+
+// Translate host exception flags to fflags bits
+static uint32_t host_flags_to_fflags(int host) {
+    uint32_t flags = 0;
+    if (host & FE_INEXACT)   flags |= FFLAG_NX;
+    if (host & FE_UNDERFLOW) flags |= FFLAG_UF;
+    if (host & FE_OVERFLOW)  flags |= FFLAG_OF;
+    if (host & FE_DIVBYZERO) flags |= FFLAG_DZ;
+    if (host & FE_INVALID)   flags |= FFLAG_NV;
+    return flags;
+}
+
+// Fold the exception flags raised on the host since the last call into fflags.
+// Operations leave the host flags sticky and only this reads them, so the common
+// path costs no fenv calls at all
+void sync_fp_flags() {
+    fcsr |= host_flags_to_fflags(fetestexcept(FE_ALL_EXCEPT));
+    feclearexcept(FE_ALL_EXCEPT);
+}
+
+// Resolve the rm field of an instruction. Returns -1 (and halts) for reserved modes
+static int resolve_rounding_mode(uint32_t rm) {
+    if (rm == RM_DYN) {
+        rm = (fcsr >> 5) & 0x7;
+    }
+    if (rm > RM_RMM) {
+        printf("Error: Illegal rounding mode %d. Halting simulation.\n", rm);
+        running = 0;
+        return -1;
+    }
+    return rm;
+}
+
+// Single-precision operation on the host FPU (SSE scalar ops on x86-64).
+// volatile keeps the compiler from moving the operation across the fenv calls
+static float host_op_float(int op, float a, float b, float c) {
+    volatile float x = a, y = b, z = c;
+    volatile float result;
+    switch (op) {
+        case FP_ADD:  result = x + y; break;
+        case FP_SUB:  result = x - y; break;
+        case FP_MUL:  result = x * y; break;
+        case FP_DIV:  result = x / y; break;
+        case FP_SQRT: result = sqrtf(x); break;
+        default:      result = fmaf(x, y, z); break;
+    }
+    return result;
+}
+
+// The same operation in double precision, used to emulate RMM
+static double host_op_double(int op, double a, double b, double c) {
+    volatile double x = a, y = b, z = c;
+    volatile double result;
+    switch (op) {
+        case FP_ADD:  result = x + y; break;
+        case FP_SUB:  result = x - y; break;
+        case FP_MUL:  result = x * y; break;
+        case FP_DIV:  result = x / y; break;
+        case FP_SQRT: result = sqrt(x); break;
+        default:      result = fma(x, y, z); break;
+    }
+    return result;
+}
+
+// Round a double to single precision with ties away from zero (RMM)
+static uint32_t double_to_float_rmm(double input, uint32_t *flags) {
+    volatile double value = input; // Keeps the conversion below between the fesetround() calls
+    if (isnan(value)) {
+        return CANONICAL_NAN;
+    }
+
+    fesetround(FE_TOWARDZERO);
+    volatile float truncated = (float)value;
+    fesetround(FE_TONEAREST);
+    if ((double)truncated == value) {
+        return to_bits(truncated);
+    }
+
+    // Round away from zero if the value is at or beyond the midpoint to the next float
+    float away = nextafterf(truncated, value > 0 ? INFINITY : -INFINITY);
+    double half_ulp = isinf(away) ? ldexp(1.0, 103) : fabs((double)away - (double)truncated) / 2;
+    float result = fabs(value) >= fabs((double)truncated) + half_ulp ? away : truncated;
+
+    // Tininess is detected after rounding, as if the exponent range were unbounded
+    *flags |= FFLAG_NX;
+    if (isinf(result)) {
+        *flags |= FFLAG_OF;
+    }
+    if (fabs(value) < FLT_MIN - ldexp(1.0, -151)) {
+        *flags |= FFLAG_UF;
+    }
+    return to_bits(result);
+}
+
+// Round a double to single precision in any rounding mode
+static uint32_t double_to_float(double input, int rm, uint32_t *flags) {
+    if (rm == RM_RMM) {
+        // The emulation raises host flags of its own, keep them out of fflags
+        sync_fp_flags();
+        uint32_t result = double_to_float_rmm(input, flags);
+        feclearexcept(FE_ALL_EXCEPT);
+        return result;
+    }
+    volatile double value = input; // Keeps the conversion below between the fesetround() calls
+    if (rm != RM_RNE) {
+        fesetround(host_rounding[rm]);
+    }
+    volatile float result = (float)value;
+    if (rm != RM_RNE) {
+        fesetround(FE_TONEAREST);
+    }
+    return to_bits(result);
+}
+
+// Perform a rounding arithmetic operation. Its exception flags are left on the host
+// for sync_fp_flags(), except for RMM which computes them itself
+static uint32_t fp_arith(int op, uint32_t a, uint32_t b, uint32_t c, int rm, uint32_t *flags) {
+    uint32_t result;
+
+    if (rm == RM_RNE) {
+        result = to_bits(host_op_float(op, to_float(a), to_float(b), to_float(c))); // Host default mode
+    } else if (rm != RM_RMM) {
+        fesetround(host_rounding[rm]);
+        result = to_bits(host_op_float(op, to_float(a), to_float(b), to_float(c)));
+        fesetround(FE_TONEAREST);
+    } else {
+        // Round to odd in double precision, then round that to single precision.
+        // Double has more than 24 + 2 bits, so the result is correctly rounded
+        sync_fp_flags();
+        fesetround(FE_TOWARDZERO);
+        feclearexcept(FE_ALL_EXCEPT);
+        double wide = host_op_double(op, to_float(a), to_float(b), to_float(c));
+        int host = fetestexcept(FE_ALL_EXCEPT);
+        fesetround(FE_TONEAREST);
+
+        *flags |= host_flags_to_fflags(host & (FE_INVALID | FE_DIVBYZERO));
+        if ((host & FE_INEXACT) && isfinite(wide)) {
+            uint64_t bits;
+            memcpy(&bits, &wide, sizeof(bits));
+            bits |= 1;
+            memcpy(&wide, &bits, sizeof(bits));
+        }
+        result = double_to_float_rmm(wide, flags);
+        feclearexcept(FE_ALL_EXCEPT);
+    }
+
+    // inf * 0 is invalid even when the addend is a quiet NaN
+    if (op == FP_FMA && ((is_inf(a) && is_zero(b)) || (is_zero(a) && is_inf(b)))) {
+        *flags |= FFLAG_NV;
+    }
+    if (is_nan(result)) {
+        result = CANONICAL_NAN;
+    }
+    return result;
+}
+
+// FMIN.S / FMAX.S: a single NaN operand is ignored, -0 is less than +0
+static uint32_t fp_min_max(uint32_t a, uint32_t b, int is_max, uint32_t *flags) {
+    if (is_snan(a) || is_snan(b)) {
+        *flags |= FFLAG_NV;
+    }
+    if (is_nan(a) && is_nan(b)) {
+        return CANONICAL_NAN;
+    }
+    if (is_nan(a)) {
+        return b;
+    }
+    if (is_nan(b)) {
+        return a;
+    }
+    if (is_zero(a) && is_zero(b)) {
+        return is_max ? (a & b) : (a | b);
+    }
+    float fa = to_float(a), fb = to_float(b);
+    return (is_max ? fa > fb : fa < fb) ? a : b;
+}
+
+// FEQ.S (quiet) / FLT.S / FLE.S (signaling)
+static uint32_t fp_compare(uint32_t a, uint32_t b, uint32_t funct3, uint32_t *flags) {
+    if (is_nan(a) || is_nan(b)) {
+        if (funct3 != 0x2 || is_snan(a) || is_snan(b)) {
+            *flags |= FFLAG_NV;
+        }
+        return 0;
+    }
+    float fa = to_float(a), fb = to_float(b);
+    switch (funct3) {
+        case 0x2: return fa == fb;
+        case 0x1: return fa < fb;
+        default:  return fa <= fb;
+    }
+}
+
+// FCLASS.S: one-hot mask of the value's class
+static uint32_t fp_classify(uint32_t a) {
+    uint32_t sign = a >> 31;
+    uint32_t exponent = (a >> 23) & 0xFF;
+    uint32_t fraction = a & 0x7FFFFF;
+
+    if (exponent == 0xFF) {
+        if (fraction == 0) {
+            return sign ? (1 << 0) : (1 << 7); // -inf / +inf
+        }
+        return is_snan(a) ? (1 << 8) : (1 << 9); // Signaling / quiet NaN
+    }
+    if (exponent == 0) {
+        if (fraction == 0) {
+            return sign ? (1 << 3) : (1 << 4); // -0 / +0
+        }
+        return sign ? (1 << 2) : (1 << 5); // Negative / positive subnormal
+    }
+    return sign ? (1 << 1) : (1 << 6); // Negative / positive normal
+}
+
+// FCVT.W.S / FCVT.WU.S: out of range values and NaN saturate and raise invalid
+static uint32_t fp_to_int(uint32_t a, int rm, int is_unsigned, uint32_t *flags) {
+    if (is_nan(a)) {
+        *flags |= FFLAG_NV;
+        return is_unsigned ? 0xFFFFFFFF : 0x7FFFFFFF;
+    }
+
+    double value = to_float(a);
+    double rounded;
+    switch (rm) {
+        case RM_RTZ: rounded = trunc(value); break;
+        case RM_RDN: rounded = floor(value); break;
+        case RM_RUP: rounded = ceil(value); break;
+        case RM_RMM: rounded = round(value); break;
+        default:     rounded = nearbyint(value); break; // Host is left in round to nearest even
+    }
+
+    if (is_unsigned) {
+        if (rounded < 0) {
+            *flags |= FFLAG_NV;
+            return 0;
+        }
+        if (rounded > 4294967295.0) {
+            *flags |= FFLAG_NV;
+            return 0xFFFFFFFF;
+        }
+    } else {
+        if (rounded < -2147483648.0) {
+            *flags |= FFLAG_NV;
+            return 0x80000000;
+        }
+        if (rounded > 2147483647.0) {
+            *flags |= FFLAG_NV;
+            return 0x7FFFFFFF;
+        }
+    }
+    if (rounded != value) {
+        *flags |= FFLAG_NX;
+    }
+    return is_unsigned ? (uint32_t)rounded : (uint32_t)(int32_t)rounded;
+}
+
+void init_fpu() {
+    for (int i = 0; i < NUM_FREGISTERS; i++) {
+        fregisters[i] = 0;
+    }
+    fcsr = 0;
+    feclearexcept(FE_ALL_EXCEPT);
+}
+
+int read_fp_csr(uint32_t csr, uint32_t *value) {
+    if (csr == CSR_FFLAGS || csr == CSR_FCSR) {
+        sync_fp_flags();
+    }
+    switch (csr) {
+        case CSR_FFLAGS: *value = fcsr & 0x1F; return 1;
+        case CSR_FRM:    *value = (fcsr >> 5) & 0x7; return 1;
+        case CSR_FCSR:   *value = fcsr & 0xFF; return 1;
+        default:         return 0;
+    }
+}
+
+void write_fp_csr(uint32_t csr, uint32_t value) {
+    sync_fp_flags(); // Pending flags were raised before this write
+    switch (csr) {
+        case CSR_FFLAGS: fcsr = (fcsr & ~0x1F) | (value & 0x1F); break;
+        case CSR_FRM:    fcsr = (fcsr & 0x1F) | ((value & 0x7) << 5); break;
+        case CSR_FCSR:   fcsr = value & 0xFF; break;
+    }
+}
+
+// Execute a single F extension instruction
+void execute_fp(uint32_t instruction) {
+    uint32_t opcode = instruction & 0x7F;
+    uint32_t rd = (instruction >> 7) & 0x1F;
+    uint32_t funct3 = (instruction >> 12) & 0x07;
+    uint32_t rs1 = (instruction >> 15) & 0x1F;
+    uint32_t rs2 = (instruction >> 20) & 0x1F;
+    uint32_t funct7 = (instruction >> 25) & 0x7F;
+    uint32_t flags = 0;
+    int rm;
+
+    switch (opcode) {
+        case 0x07: { // FLW
+            int32_t imm = sign_extend((instruction >> 20), 12);
+            uint32_t address = registers[rs1] + imm;
+            if (funct3 != 0x2 || address > MEMORY_SIZE - 4) {
+                printf("Error: Invalid FLW (funct3 0x%x, address 0x%x)\n", funct3, address);
+                running = 0;
+                return;
+            }
+            fregisters[rd] = memory[address] | (memory[address + 1] << 8) | (memory[address + 2] << 16)
+                           | ((uint32_t)memory[address + 3] << 24);
+            TRACE("FLW f%d, %d(x%d) -> f%d = 0x%x\n", rd, imm, rs1, rd, fregisters[rd]);
+            break;
+        }
+        case 0x27: { // FSW
+            int32_t imm = ((instruction >> 25) << 5) | ((instruction >> 7) & 0x1F);
+            imm = sign_extend(imm, 12);
+            uint32_t address = registers[rs1] + imm;
+            if (funct3 != 0x2 || address > MEMORY_SIZE - 4) {
+                printf("Error: Invalid FSW (funct3 0x%x, address 0x%x)\n", funct3, address);
+                running = 0;
+                return;
+            }
+            for (int i = 0; i < 4; i++) {
+                memory[address + i] = (fregisters[rs2] >> (8 * i)) & 0xFF;
+            }
+            TRACE("FSW: Storing word 0x%x from f%d to memory address 0x%x\n", fregisters[rs2], rs2, address);
+            break;
+        }
+        case 0x43: // FMADD.S:  rs1 * rs2 + rs3
+        case 0x47: // FMSUB.S:  rs1 * rs2 - rs3
+        case 0x4B: // FNMSUB.S: -(rs1 * rs2) + rs3
+        case 0x4F: { // FNMADD.S: -(rs1 * rs2) - rs3
+            if ((funct7 & 0x3) != 0) {
+                printf("Unknown FMA format: 0x%x\n", funct7 & 0x3);
+                running = 0;
+                return;
+            }
+            if ((rm = resolve_rounding_mode(funct3)) < 0) {
+                return;
+            }
+            uint32_t rs3 = instruction >> 27;
+            uint32_t a = fregisters[rs1];
+            uint32_t c = fregisters[rs3];
+            if (opcode == 0x4B || opcode == 0x4F) {
+                a ^= SIGN_BIT;
+            }
+            if (opcode == 0x47 || opcode == 0x4F) {
+                c ^= SIGN_BIT;
+            }
+            fregisters[rd] = fp_arith(FP_FMA, a, fregisters[rs2], c, rm, &flags);
+            TRACE("FMA (opcode 0x%x) f%d, f%d, f%d, f%d -> f%d = 0x%x\n", opcode, rd, rs1, rs2, rs3, rd, fregisters[rd]);
+            break;
+        }
+        case 0x53: { // OP-FP
+            switch (funct7) {
+                case 0x00: // FADD.S
+                case 0x04: // FSUB.S
+                case 0x08: // FMUL.S
+                case 0x0C: // FDIV.S
+                case 0x2C: { // FSQRT.S
+                    static const char *names[] = {"FADD.S", "FSUB.S", "FMUL.S", "FDIV.S"};
+                    if (funct7 == 0x2C && rs2 != 0) {
+                        printf("Unknown FSQRT rs2: 0x%x\n", rs2);
+                        running = 0;
+                        return;
+                    }
+                    if ((rm = resolve_rounding_mode(funct3)) < 0) {
+                        return;
+                    }
+                    int op = funct7 == 0x2C ? FP_SQRT : (int)(funct7 >> 2);
+                    fregisters[rd] = fp_arith(op, fregisters[rs1], fregisters[rs2], 0, rm, &flags);
+                    TRACE("%s f%d, f%d, f%d -> f%d = 0x%x\n", op == FP_SQRT ? "FSQRT.S" : names[op], rd, rs1, rs2, rd, fregisters[rd]);
+                    break;
+                }
+                case 0x10: { // FSGNJ.S, FSGNJN.S, FSGNJX.S
+                    uint32_t a = fregisters[rs1] & ~SIGN_BIT;
+                    uint32_t sign = fregisters[rs2] & SIGN_BIT;
+                    switch (funct3) {
+                        case 0x0: fregisters[rd] = a | sign; break;
+                        case 0x1: fregisters[rd] = a | (sign ^ SIGN_BIT); break;
+                        case 0x2: fregisters[rd] = a | ((fregisters[rs1] ^ sign) & SIGN_BIT); break;
+                        default:
+                            printf("Unknown FSGNJ funct3: 0x%x\n", funct3);
+                            running = 0;
+                            return;
+                    }
+                    TRACE("FSGNJ (funct3 0x%x) f%d, f%d, f%d -> f%d = 0x%x\n", funct3, rd, rs1, rs2, rd, fregisters[rd]);
+                    break;
+                }
+                case 0x14: // FMIN.S, FMAX.S
+                    if (funct3 > 0x1) {
+                        printf("Unknown FMIN/FMAX funct3: 0x%x\n", funct3);
+                        running = 0;
+                        return;
+                    }
+                    fregisters[rd] = fp_min_max(fregisters[rs1], fregisters[rs2], funct3 == 0x1, &flags);
+                    TRACE("%s f%d, f%d, f%d -> f%d = 0x%x\n", funct3 == 0x1 ? "FMAX.S" : "FMIN.S", rd, rs1, rs2, rd, fregisters[rd]);
+                    break;
+                case 0x50: { // FEQ.S, FLT.S, FLE.S
+                    if (funct3 > 0x2) {
+                        printf("Unknown FCMP funct3: 0x%x\n", funct3);
+                        running = 0;
+                        return;
+                    }
+                    uint32_t result = fp_compare(fregisters[rs1], fregisters[rs2], funct3, &flags);
+                    if (rd != 0) {
+                        registers[rd] = result;
+                    }
+                    TRACE("FCMP (funct3 0x%x) x%d, f%d, f%d -> x%d = %d\n", funct3, rd, rs1, rs2, rd, result);
+                    break;
+                }
+                case 0x60: { // FCVT.W.S, FCVT.WU.S
+                    if (rs2 > 0x1) { // FCVT.L[U].S are RV64 only
+                        printf("Unknown FCVT rs2: 0x%x\n", rs2);
+                        running = 0;
+                        return;
+                    }
+                    if ((rm = resolve_rounding_mode(funct3)) < 0) {
+                        return;
+                    }
+                    uint32_t result = fp_to_int(fregisters[rs1], rm, rs2 == 1, &flags);
+                    if (rd != 0) {
+                        registers[rd] = result;
+                    }
+                    TRACE("%s x%d, f%d -> x%d = 0x%x\n", rs2 == 1 ? "FCVT.WU.S" : "FCVT.W.S", rd, rs1, rd, result);
+                    break;
+                }
+                case 0x68: { // FCVT.S.W, FCVT.S.WU
+                    if (rs2 > 0x1) { // FCVT.S.L[U] are RV64 only
+                        printf("Unknown FCVT rs2: 0x%x\n", rs2);
+                        running = 0;
+                        return;
+                    }
+                    if ((rm = resolve_rounding_mode(funct3)) < 0) {
+                        return;
+                    }
+                    double value = rs2 == 1 ? (double)registers[rs1] : (double)(int32_t)registers[rs1];
+                    fregisters[rd] = double_to_float(value, rm, &flags);
+                    TRACE("%s f%d, x%d -> f%d = 0x%x\n", rs2 == 1 ? "FCVT.S.WU" : "FCVT.S.W", rd, rs1, rd, fregisters[rd]);
+                    break;
+                }
+                case 0x70: { // FMV.X.W, FCLASS.S
+                    if (funct3 > 0x1 || rs2 != 0) {
+                        printf("Unknown FMV.X.W/FCLASS funct3: 0x%x, rs2: 0x%x\n", funct3, rs2);
+                        running = 0;
+                        return;
+                    }
+                    uint32_t result = funct3 == 0x1 ? fp_classify(fregisters[rs1]) : fregisters[rs1];
+                    if (rd != 0) {
+                        registers[rd] = result;
+                    }
+                    TRACE("%s x%d, f%d -> x%d = 0x%x\n", funct3 == 0x1 ? "FCLASS.S" : "FMV.X.W", rd, rs1, rd, result);
+                    break;
+                }
+                case 0x78: // FMV.W.X
+                    if (funct3 != 0 || rs2 != 0) {
+                        printf("Unknown FMV.W.X funct3: 0x%x, rs2: 0x%x\n", funct3, rs2);
+                        running = 0;
+                        return;
+                    }
+                    fregisters[rd] = registers[rs1];
+                    TRACE("FMV.W.X f%d, x%d -> f%d = 0x%x\n", rd, rs1, rd, fregisters[rd]);
+                    break;
+                default:
+                    printf("Unknown OP-FP funct7: 0x%x\n", funct7);
+                    running = 0;
+                    return;
+            }
+            break;
+        }
+        default:
+            printf("Unknown FP opcode: 0x%x\n", opcode);
+            running = 0;
+            return;
+    }
+
+    fcsr |= flags;
+}
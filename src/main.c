@@ -1,35 +1,112 @@
 #include <stdio.h>
 #include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
 #include "simulator.h"
 #include "memory.h"
 #include "decoder.h"
+#include "replay.h"
+#include "cache.h"
+#include "fpu.h"
 
 int main(int argc, char *argv[]) {
-    if (argc < 2) {
-        printf("Usage: %s <binary_file>\n", argv[0]);
+    const char *binary_file = NULL;
+    const char *replay_file = NULL;
+    const char *cache_dir = NULL;
+    int mode = REPLAY_OFF;
+    uint64_t trace_from = 0;          // Only trace instructions in [trace_from, trace_to)
+    uint64_t trace_to = UINT64_MAX;
+
+    for (int i = 1; i < argc; i++) {
+        if ((strcmp(argv[i], "--record") == 0 || strcmp(argv[i], "--replay") == 0) && i + 1 < argc) {
+            mode = strcmp(argv[i], "--record") == 0 ? REPLAY_RECORD : REPLAY_REPLAY;
+            replay_file = argv[++i];
+        } else if (strcmp(argv[i], "--trace-from") == 0 && i + 1 < argc) {
+            trace_from = strtoull(argv[++i], NULL, 0);
+        } else if (strcmp(argv[i], "--trace-to") == 0 && i + 1 < argc) {
+            trace_to = strtoull(argv[++i], NULL, 0);
+        } else if (strcmp(argv[i], "--checkpoint-every") == 0 && i + 1 < argc) {
+            replay_checkpoint_interval = strtoull(argv[++i], NULL, 0);
+        } else if (strcmp(argv[i], "--cache") == 0 && i + 1 < argc) {
+            cache_dir = argv[++i];
+        } else {
+            binary_file = argv[i];
+        }
+    }
+    if (!binary_file) {
+        printf("Usage: %s [--record <log> | --replay <log>] [--checkpoint-every <n>] [--cache <dir>]\n"
+               "       [--trace-from <n>] [--trace-to <n>] <binary_file>\n"
+               "--record also writes a checkpoint to <log>.ckpt every <n> instructions (default %d, 0 disables).\n"
+               "--replay with --trace-from resumes from the latest checkpoint before the trace window.\n"
+               "Programs that read nondeterministic input (e.g. the time CSR) are never cached.\n",
+               argv[0], REPLAY_CHECKPOINT_INTERVAL);
         return 1;
     }
 
     init_simulator();
-    load_instructions(argv[1]);
+    size_t image_size = load_instructions(binary_file);
+    uint64_t key = cache_key(image_size); // Identifies the image for both the cache and the replay log
+    if (mode != REPLAY_OFF) {
+        replay_open(replay_file, mode, key);
+        cache_dir = NULL; // Recorded and replayed runs must actually execute
+    }
+    if (mode == REPLAY_REPLAY && trace_from > 0) {
+        replay_restore_checkpoint(trace_from);
+    }
+
+    // Reuse the result of an earlier run of the same image on the same engine
+    cache_result result;
+    if (cache_dir) {
+        if (cache_lookup(cache_dir, key, &result)) {
+            printf("Cache hit %016llx: %llu instructions, exit reason %u\n",
+                (unsigned long long)key, (unsigned long long)result.instruction_count, result.exit_reason);
+            write_register_values("output.bin", result.output);
+            return 0;
+        }
+    }
 
     printf("RISC-V Simulator Starting...\n");
 
     while (PC < MEMORY_SIZE && running) {
+        trace_enabled = instruction_count >= trace_from && instruction_count < trace_to;
+        if (mode == REPLAY_RECORD) {
+            replay_checkpoint();
+        }
         uint32_t instruction = fetch_instruction();
-        printf("Current PC: 0x%x, Next Instruction: 0x%x\n", PC, instruction);
+        if (!running) {
+            break; // Fetch failed (PC out of bounds or illegal instruction)
+        }
+        TRACE("Current PC: 0x%x, Next Instruction: 0x%x\n", PC, instruction);
 
         decode_and_execute(instruction);
         // Check for JAL, JALR and ECALL to prevent incrementing PC
         if (running && (instruction & 0x7F) != 0x6F && (instruction & 0x7F) != 0x67 && (instruction & 0x7F) != 0x63) {
-            PC += 4;
+            PC += instruction_length;
         }
-        printf("Next PC: 0x%x\n", PC);
+        instruction_count++;
+        TRACE("Next PC: 0x%x\n", PC);
+    }
+    trace_enabled = 1;
+    sync_fp_flags(); // Leave the final fflags in fcsr
+    replay_close();
+    if (exit_reason == EXIT_NONE) {
+        exit_reason = PC >= MEMORY_SIZE ? EXIT_PC_OUT_OF_BOUNDS : EXIT_HALTED;
     }
 
     // Print the register state before the file write for debugging
     print_registers();
     //write the file
     write_output_binary("output.bin");
-    return 0;
-}
\ No newline at end of file
+
+    // A run that read the host clock is not a function of its key, so it is never cached
+    if (cache_dir && replay_used) {
+        printf("Not caching result: the program read nondeterministic input\n");
+    } else if (cache_dir) {
+        memset(&result, 0, sizeof(result));
+        result.instruction_count = instruction_count;
+        result.exit_reason = exit_reason;
+        output_register_values(result.output);
+        cache_store(cache_dir, key, &result);
+    }
+    return replay_diverged ? 1 : 0; // Lets batch scripts detect a replay that did not match its log
+}
@@ -3,11 +3,13 @@
 #include <stdlib.h>
 #include "memory.h"
 #include "simulator.h"
+#include "compressed.h"
 
 uint8_t memory[MEMORY_SIZE] = {0}; // Initialize memory to zero
+uint32_t instruction_length = 4;
 
 // Load instructions from a binary file into memory, one byte at a time
-void load_instructions(const char *filename) {
+size_t load_instructions(const char *filename) {
     FILE *file = fopen(filename, "rb");
     if (!file) {
         perror("Error opening file");
@@ -18,16 +20,38 @@ void load_instructions(const char *filename) {
     fclose(file);
 
     printf("Loaded %zu bytes into memory.\n", bytes_read);
+    return bytes_read;
 }
 
-// Fetch the next instruction from memory
+// Fetch the next instruction from memory. 16-bit (RV32C) instructions are expanded
+// to their 32-bit equivalents here, so the decoder only ever sees 32-bit instructions
 uint32_t fetch_instruction() {
-    if (PC >= MEMORY_SIZE) {
+    if (PC + 2 > MEMORY_SIZE) {
         printf("Error: PC out of bounds (0x%x). Halting simulation.\n", PC);
         running = 0;
         return 0;
     }
-    uint32_t instruction = *((uint32_t *)(memory + PC)); // Read 4 bytes from memory
-    printf("Fetched instruction 0x%x at PC: 0x%x\n", instruction, PC);
+    uint16_t low = memory[PC] | (memory[PC + 1] << 8); // PC is only 2-byte aligned, read byte-wise
+    if (is_compressed(low)) {
+        instruction_length = 2;
+        uint32_t instruction = expand_compressed(low);
+        if (instruction == 0) {
+            // Includes the all-zero halfword, so running into zeroed memory stops here
+            printf("Error: Illegal instruction 0x%x at PC: 0x%x. Halting simulation.\n", low, PC);
+            running = 0;
+            return 0;
+        }
+        TRACE("Fetched compressed instruction 0x%x at PC: 0x%x -> 0x%x\n", low, PC, instruction);
+        return instruction;
+    }
+
+    if (PC + 4 > MEMORY_SIZE) {
+        printf("Error: PC out of bounds (0x%x). Halting simulation.\n", PC);
+        running = 0;
+        return 0;
+    }
+    instruction_length = 4;
+    uint32_t instruction = low | (memory[PC + 2] << 16) | ((uint32_t)memory[PC + 3] << 24);
+    TRACE("Fetched instruction 0x%x at PC: 0x%x\n", instruction, PC);
     return instruction;
 }
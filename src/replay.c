@@ -0,0 +1,234 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "replay.h"
+#include "simulator.h"
+#include "memory.h"
+#include "decoder.h"
+#include "fpu.h"
+
+#define REPLAY_MAGIC "RVRL"
+#define REPLAY_VERSION 2
+#define REPLAY_EVENT_END 0 // End-of-run marker, value holds the final PC
+
+// Checkpoints go to a sidecar file next to the log, <log>.ckpt
+#define CHECKPOINT_MAGIC "RVCK"
+#define CHECKPOINT_SUFFIX ".ckpt"
+
+// One log entry: which instruction asked for the value, what kind it was and the value itself
+typedef struct {
+    uint64_t instruction;
+    uint32_t kind;
+    uint32_t value;
+} replay_record;
+
+// Machine state after `instruction` instructions. Each one is followed by the whole of memory
+typedef struct {
+    uint64_t instruction;                  // Instructions executed when the state was saved
+    uint64_t log_offset;                   // Position in the log of the next record to read
+    uint32_t PC;
+    uint32_t registers[NUM_REGISTERS];
+    uint32_t fregisters[NUM_FREGISTERS];
+    uint32_t fcsr;
+    uint32_t stack_pointer_used;
+} replay_checkpoint_state;
+
+int replay_mode = REPLAY_OFF;
+int replay_diverged = 0;
+int replay_used = 0;
+uint64_t replay_checkpoint_interval = REPLAY_CHECKPOINT_INTERVAL;
+static FILE *replay_file = NULL;
+static FILE *checkpoint_file = NULL;
+static char checkpoint_path[4096 + sizeof(CHECKPOINT_SUFFIX)];
+static uint64_t image_hash_opened = 0;    // Image the log belongs to, checkpoints must match it too
+static uint64_t next_checkpoint = UINT64_MAX;
+
+// Open the replay log and write or check its header. The header holds the hash of the
+// recorded image, so a log is never replayed against a different program
+void replay_open(const char *filename, int mode, uint64_t image_hash) {
+    replay_file = fopen(filename, mode == REPLAY_RECORD ? "wb" : "rb");
+    if (!replay_file) {
+        perror("Error opening replay log");
+        exit(EXIT_FAILURE);
+    }
+    replay_mode = mode;
+    image_hash_opened = image_hash;
+    snprintf(checkpoint_path, sizeof(checkpoint_path), "%s" CHECKPOINT_SUFFIX, filename);
+
+    char magic[4];
+    uint32_t version = REPLAY_VERSION;
+    uint64_t recorded_hash = image_hash;
+    if (mode == REPLAY_RECORD) {
+        fwrite(REPLAY_MAGIC, 1, 4, replay_file);
+        fwrite(&version, sizeof(uint32_t), 1, replay_file);
+        fwrite(&image_hash, sizeof(uint64_t), 1, replay_file);
+        printf("Recording nondeterministic events to %s\n", filename);
+
+        if (replay_checkpoint_interval) {
+            checkpoint_file = fopen(checkpoint_path, "wb");
+            if (!checkpoint_file) {
+                perror("Error opening checkpoint file");
+                exit(EXIT_FAILURE);
+            }
+            fwrite(CHECKPOINT_MAGIC, 1, 4, checkpoint_file);
+            fwrite(&version, sizeof(uint32_t), 1, checkpoint_file);
+            fwrite(&image_hash, sizeof(uint64_t), 1, checkpoint_file);
+            next_checkpoint = replay_checkpoint_interval;
+        } else {
+            remove(checkpoint_path); // Never leave checkpoints of an older recording next to this log
+        }
+    } else {
+        if (fread(magic, 1, 4, replay_file) != 4 || memcmp(magic, REPLAY_MAGIC, 4) != 0 ||
+            fread(&version, sizeof(uint32_t), 1, replay_file) != 1 || version != REPLAY_VERSION ||
+            fread(&recorded_hash, sizeof(uint64_t), 1, replay_file) != 1) {
+            printf("Error: %s is not a replay log (version %d)\n", filename, REPLAY_VERSION);
+            exit(EXIT_FAILURE);
+        }
+        if (recorded_hash != image_hash) {
+            printf("Error: %s was recorded from a different image (%016llx, this image is %016llx)\n",
+                filename, (unsigned long long)recorded_hash, (unsigned long long)image_hash);
+            exit(EXIT_FAILURE);
+        }
+        printf("Replaying nondeterministic events from %s\n", filename);
+    }
+}
+
+// Read the next record from the log, checking that it matches what the run asks for
+static int replay_next(uint32_t kind, replay_record *record) {
+    if (fread(record, sizeof(replay_record), 1, replay_file) != 1) {
+        printf("Replay diverged: log ended before instruction %llu\n", (unsigned long long)instruction_count);
+        return 0;
+    }
+    if (record->kind != kind || record->instruction != instruction_count) {
+        printf("Replay diverged: expected event %u at instruction %llu, log has event %u at instruction %llu\n",
+            kind, (unsigned long long)instruction_count, record->kind, (unsigned long long)record->instruction);
+        return 0;
+    }
+    return 1;
+}
+
+// Record or replay one nondeterministic value. With replay off, the host value is used as is
+uint32_t replay_event(uint32_t kind, uint32_t host_value) {
+    replay_used = 1;
+    replay_record record = {instruction_count, kind, host_value};
+
+    if (replay_mode == REPLAY_RECORD) {
+        fwrite(&record, sizeof(replay_record), 1, replay_file);
+    } else if (replay_mode == REPLAY_REPLAY) {
+        if (replay_diverged || !replay_next(kind, &record)) {
+            // Never let live host state into a replayed run
+            replay_diverged = 1;
+            running = 0;
+            return 0;
+        }
+        TRACE("Replay: event %u at instruction %llu -> 0x%x\n", kind, (unsigned long long)record.instruction, record.value);
+    }
+    return record.value;
+}
+
+// Save the machine state to the checkpoint file every replay_checkpoint_interval instructions
+void replay_checkpoint() {
+    if (instruction_count != next_checkpoint) {
+        return;
+    }
+    next_checkpoint += replay_checkpoint_interval;
+
+    sync_fp_flags();
+    replay_checkpoint_state state;
+    memset(&state, 0, sizeof(state));
+    state.instruction = instruction_count;
+    state.log_offset = ftell(replay_file);
+    state.PC = PC;
+    memcpy(state.registers, registers, sizeof(state.registers));
+    memcpy(state.fregisters, fregisters, sizeof(state.fregisters));
+    state.fcsr = fcsr;
+    state.stack_pointer_used = stack_pointer_used;
+    fwrite(&state, sizeof(state), 1, checkpoint_file);
+    fwrite(memory, 1, MEMORY_SIZE, checkpoint_file);
+    TRACE("Checkpoint at instruction %llu\n", (unsigned long long)instruction_count);
+}
+
+// Restore the latest checkpoint taken at or before instruction `target` and move the log
+// to the matching record, so replaying up to a trace window skips the instructions before it
+void replay_restore_checkpoint(uint64_t target) {
+    FILE *file = fopen(checkpoint_path, "rb");
+    if (!file) {
+        printf("No checkpoints in %s, replaying from the start\n", checkpoint_path);
+        return;
+    }
+
+    char magic[4];
+    uint32_t version;
+    uint64_t image_hash;
+    if (fread(magic, 1, 4, file) != 4 || memcmp(magic, CHECKPOINT_MAGIC, 4) != 0 ||
+        fread(&version, sizeof(uint32_t), 1, file) != 1 || version != REPLAY_VERSION ||
+        fread(&image_hash, sizeof(uint64_t), 1, file) != 1 || image_hash != image_hash_opened) {
+        printf("Error: %s does not belong to this replay log\n", checkpoint_path);
+        exit(EXIT_FAILURE);
+    }
+
+    // Checkpoints have a fixed size and increasing instruction counts, so only their headers are read
+    replay_checkpoint_state state, best;
+    long best_offset = -1;
+    long offset = ftell(file);
+    while (fread(&state, sizeof(state), 1, file) == 1 && state.instruction <= target) {
+        best = state;
+        best_offset = offset;
+        offset += sizeof(state) + MEMORY_SIZE;
+        if (fseek(file, offset, SEEK_SET) != 0) {
+            break;
+        }
+    }
+    if (best_offset < 0) {
+        fclose(file);
+        return; // trace_from is before the first checkpoint
+    }
+
+    if (fseek(file, best_offset + sizeof(best), SEEK_SET) != 0 ||
+        fread(memory, 1, MEMORY_SIZE, file) != MEMORY_SIZE ||
+        fseek(replay_file, best.log_offset, SEEK_SET) != 0) {
+        printf("Error: %s is truncated\n", checkpoint_path);
+        exit(EXIT_FAILURE);
+    }
+    fclose(file);
+
+    instruction_count = best.instruction;
+    PC = best.PC;
+    memcpy(registers, best.registers, sizeof(best.registers));
+    memcpy(fregisters, best.fregisters, sizeof(best.fregisters));
+    write_fp_csr(CSR_FCSR, best.fcsr);
+    stack_pointer_used = best.stack_pointer_used;
+    printf("Restored checkpoint at instruction %llu\n", (unsigned long long)instruction_count);
+}
+
+// Write the end-of-run marker, or check that the replayed run ended where the recorded one did
+void replay_close() {
+    if (!replay_file) {
+        return;
+    }
+
+    replay_record record = {instruction_count, REPLAY_EVENT_END, PC};
+    if (replay_mode == REPLAY_RECORD) {
+        fwrite(&record, sizeof(replay_record), 1, replay_file);
+        printf("Recorded run of %llu instructions\n", (unsigned long long)instruction_count);
+    } else if (replay_diverged) {
+        printf("Replay stopped at instruction %llu after diverging\n", (unsigned long long)instruction_count);
+    } else if (!replay_next(REPLAY_EVENT_END, &record)) {
+        replay_diverged = 1;
+    } else if (record.value != PC) {
+        printf("Replay diverged: final PC 0x%x, recorded 0x%x\n", PC, record.value);
+        replay_diverged = 1;
+    } else {
+        printf("Replay matched recording (%llu instructions)\n", (unsigned long long)instruction_count);
+    }
+
+    fclose(replay_file);
+    replay_file = NULL;
+    if (checkpoint_file) {
+        fclose(checkpoint_file);
+        checkpoint_file = NULL;
+    }
+    next_checkpoint = UINT64_MAX;
+    replay_mode = REPLAY_OFF;
+}
@@ -2,10 +2,14 @@
 #include <stdint.h>
 #include "simulator.h"
 #include "decoder.h"
+#include "fpu.h"
 
 uint32_t registers[NUM_REGISTERS] = {0};
 uint32_t PC = 0; // Program Counter
+uint64_t instruction_count = 0; // Instructions executed, drives the cycle/instret counters
 int running = 1; // Flag to stop the simulator
+int trace_enabled = 1;
+int exit_reason = EXIT_NONE;
 
 // Initialize the simulator state
 void init_simulator() {
@@ -13,7 +17,10 @@ void init_simulator() {
         registers[i] = 0;
     }
     PC = 0;
+    instruction_count = 0;
     running = 1;
+    exit_reason = EXIT_NONE;
+    init_fpu();
     registers[2] = 0x100000; // Initialize Stack Pointer (sp) to top of memory
     registers[0] = 0; // x0 is hardcoded to zero
     printf("Stack Pointer (sp) initialized to 0x100000\n");
@@ -26,22 +33,25 @@ void print_registers() {
     }
 }
 
-void write_output_binary(const char *filename) {
+// Collect the register values that go into the output file
+void output_register_values(uint32_t values[NUM_REGISTERS]) {
+    for (int i = 0; i < NUM_REGISTERS; i++) {
+        values[i] = registers[i];
+    }
+    // Skip writing x2 (stack pointer) if it was never used
+    if (!stack_pointer_used) {
+        values[2] = 0;
+    }
+}
+
+void write_register_values(const char *filename, const uint32_t values[NUM_REGISTERS]) {
     FILE *file = fopen(filename, "wb");
     if (!file) {
         perror("Error opening output file");
         return;
     }
-    printf("Before writing output, stack pointer (x2) = 0x%x\n", registers[2]);
     for (int i = 0; i < NUM_REGISTERS; i++) {
-        uint32_t value = registers[i];
-
-                // Skip writing x2 (stack pointer) if it was never used
-        if (i == 2 && !stack_pointer_used) {
-            value = 0;
-        }
-
-        size_t written = fwrite(&value, sizeof(uint32_t), 1, file);
+        size_t written = fwrite(&values[i], sizeof(uint32_t), 1, file);
         if (written != 1) {
             perror("Error writing to output file");
             fclose(file);
@@ -49,9 +59,16 @@ void write_output_binary(const char *filename) {
         }
 
         // Debug output
-        printf("Writing x%d = 0x%x to file\n", i, value);
+        printf("Writing x%d = 0x%x to file\n", i, values[i]);
     }
 
     fclose(file);
     printf("Binary output written to %s\n", filename);
 }
+
+void write_output_binary(const char *filename) {
+    uint32_t values[NUM_REGISTERS];
+    printf("Before writing output, stack pointer (x2) = 0x%x\n", registers[2]);
+    output_register_values(values);
+    write_register_values(filename, values);
+}
@@ -1,6 +1,13 @@
 #!/bin/bash
 
-TEST_DIRS=("tests/task1" "tests/task2" "tests/task3" "tests/task4")
+TEST_DIRS=("tests/task1" "tests/task2" "tests/task3" "tests/task4" "tests/task5" "tests/task6")
+
+# Set SIM_CACHE_DIR to reuse results of unchanged tests from earlier runs
+SIM_ARGS=()
+if [ -n "$SIM_CACHE_DIR" ]; then
+    mkdir -p "$SIM_CACHE_DIR"
+    SIM_ARGS=(--cache "$SIM_CACHE_DIR")
+fi
 
 # Initialize counters
 total_tests=0
@@ -20,7 +27,7 @@ for dir in "${TEST_DIRS[@]}"; do
 
         # Run the test with the simulator
         echo "Running test: $test_name"
-        ./riscv_sim "$bin_file"
+        ./riscv_sim "${SIM_ARGS[@]}" "$bin_file"
 
         # Check if the output matches the expected result
         if diff -q output.bin "$res_file" > /dev/null; then
@@ -37,6 +44,85 @@ for dir in "${TEST_DIRS[@]}"; do
     done
 done
 
+# Record a run that reads the host clock, replay it and check both runs agree.
+# Replaying into a trace window must resume from the checkpoint before it. The log
+# must be refused for a different image, and a truncated log must be reported as a divergence
+echo "Running record/replay tests"
+replay_log=$(mktemp)
+./riscv_sim --record "$replay_log" --checkpoint-every 50 tests/replay/rdtime.bin > /dev/null
+cp output.bin output.recorded.bin
+if ./riscv_sim --replay "$replay_log" tests/replay/rdtime.bin > /dev/null && diff -q output.bin output.recorded.bin > /dev/null; then
+    echo "✅ Test passed: replay rdtime"
+    passed_tests=$((passed_tests + 1))
+else
+    echo "❌ Test failed: replay rdtime"
+    failed_tests=$((failed_tests + 1))
+    failed_tests_list+=("tests/replay/rdtime")
+fi
+total_tests=$((total_tests + 1))
+replay_output=$(./riscv_sim --replay "$replay_log" --trace-from 120 tests/replay/rdtime.bin)
+if [ $? -eq 0 ] && grep -q "Restored checkpoint at instruction 100" <<< "$replay_output" && diff -q output.bin output.recorded.bin > /dev/null; then
+    echo "✅ Test passed: replay rdtime from checkpoint"
+    passed_tests=$((passed_tests + 1))
+else
+    echo "❌ Test failed: replay rdtime from checkpoint"
+    failed_tests=$((failed_tests + 1))
+    failed_tests_list+=("tests/replay/rdtime (checkpoint)")
+fi
+total_tests=$((total_tests + 1))
+if ./riscv_sim --replay "$replay_log" tests/replay/rdtime_shifted.bin | grep -q "recorded from a different image"; then
+    echo "✅ Test passed: replay of a different image refused"
+    passed_tests=$((passed_tests + 1))
+else
+    echo "❌ Test failed: replay of a different image not refused"
+    failed_tests=$((failed_tests + 1))
+    failed_tests_list+=("tests/replay/rdtime_shifted")
+fi
+total_tests=$((total_tests + 1))
+head -c 48 "$replay_log" > "$replay_log.truncated" # Header and the first two events only
+if ./riscv_sim --replay "$replay_log.truncated" tests/replay/rdtime.bin > /dev/null; then
+    echo "❌ Test failed: replay divergence not detected"
+    failed_tests=$((failed_tests + 1))
+    failed_tests_list+=("tests/replay/rdtime")
+else
+    echo "✅ Test passed: replay divergence detected"
+    passed_tests=$((passed_tests + 1))
+fi
+total_tests=$((total_tests + 1))
+rm -f "$replay_log" "$replay_log.ckpt" "$replay_log.truncated" output.recorded.bin
+
+# Run a few tests twice against an empty cache. The second run must be a hit with
+# the same output, and a program that reads the host clock must never be stored
+echo "Running cache tests"
+cache_dir=$(mktemp -d)
+for bin_file in tests/task1/addpos.bin tests/task4/t1.bin tests/task6/fp_arith.bin; do
+    test_name=$(basename "$bin_file" .bin)
+    ./riscv_sim --cache "$cache_dir" "$bin_file" > /dev/null
+    cp output.bin output.uncached.bin
+    if ./riscv_sim --cache "$cache_dir" "$bin_file" | grep -q "^Cache hit" && diff -q output.bin output.uncached.bin > /dev/null; then
+        echo "✅ Test passed: cache $test_name"
+        passed_tests=$((passed_tests + 1))
+    else
+        echo "❌ Test failed: cache $test_name"
+        failed_tests=$((failed_tests + 1))
+        failed_tests_list+=("cache/$test_name")
+    fi
+    total_tests=$((total_tests + 1))
+done
+rm -rf "$cache_dir"
+cache_dir=$(mktemp -d)
+./riscv_sim --cache "$cache_dir" tests/replay/rdtime.bin > /dev/null
+if ./riscv_sim --cache "$cache_dir" tests/replay/rdtime.bin | grep -q "^Cache hit" || [ -n "$(ls -A "$cache_dir")" ]; then
+    echo "❌ Test failed: cache stored a nondeterministic run"
+    failed_tests=$((failed_tests + 1))
+    failed_tests_list+=("cache/rdtime")
+else
+    echo "✅ Test passed: nondeterministic run not cached"
+    passed_tests=$((passed_tests + 1))
+fi
+total_tests=$((total_tests + 1))
+rm -rf "$cache_dir" output.uncached.bin
+
 # Print summary
 echo "===================================="
 echo "Test Summary:"
@@ -0,0 +1,11 @@
+	.text
+	rdtime a0
+	rdtimeh a1
+	li t0, 100
+spin:
+	addi t0, t0, -1
+	bnez t0, spin
+	rdtime a2
+	sub a3, a2, a0
+	li a7, 10
+	ecall
@@ -0,0 +1,56 @@
+	.text
+	li a0, 5
+	li a1, -3
+	lui a2, 0x1f
+	addi a2, a2, 12
+	mv a3, a1
+	add a3, a3, a0
+	mv a4, a0
+	sub a4, a4, a1
+	mv a5, a0
+	xor a5, a5, a1
+	mv s0, a0
+	or s0, s0, a1
+	mv s1, a0
+	and s1, s1, a1
+	andi a4, a4, 7
+	slli a5, a5, 4
+	srli a5, a5, 2
+	srai a1, a1, 1
+	addi sp, sp, -32
+	addi s0, sp, 8
+	sw a2, 4(s0)
+	lw a5, 4(s0)
+	mv a6, a5
+	sw a0, 12(sp)
+	lw t0, 12(sp)
+	li t1, 0
+	li a5, 6
+loop:
+	addi t1, t1, 3
+	addi a5, a5, -1
+	bnez a5, loop
+	beqz a5, skip
+	li t1, 99
+skip:
+	jal func
+	j done
+	li t2, 99
+func:
+	addi t2, t0, 1
+	ret
+done:
+	jal s1, over
+landing:
+	mv a3, t2
+	j finish
+over:
+	jalr s1
+	li a3, 99
+finish:
+	addi sp, sp, 32
+	li ra, 0
+	li s0, 0
+	li s1, 0
+	li a7, 10
+	ecall
@@ -0,0 +1,10 @@
+	.text
+	li a0, 5
+	rdinstret a1
+	addi a0, a0, 1
+	addi a0, a0, 1
+	rdcycle a2
+	rdcycleh a3
+	sub a4, a2, a1
+	li a7, 10
+	ecall
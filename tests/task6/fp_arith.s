@@ -0,0 +1,56 @@
+	.text
+	li t0, 0x3fc00000
+	fmv.w.x ft0, t0
+	li t0, 0x40200000
+	fmv.w.x ft1, t0
+	li t0, 0x40400000
+	fmv.w.x ft2, t0
+	fadd.s ft3, ft0, ft1
+	fmv.x.w a0, ft3
+	fsub.s ft3, ft0, ft1
+	fmv.x.w a1, ft3
+	fmul.s ft3, ft0, ft1
+	fmv.x.w a2, ft3
+	frflags s11
+	fdiv.s ft3, ft1, ft2
+	fmv.x.w a3, ft3
+	fsqrt.s ft3, ft2
+	fmv.x.w a4, ft3
+	fmadd.s ft3, ft0, ft1, ft2
+	fmv.x.w a5, ft3
+	fmsub.s ft3, ft0, ft1, ft2
+	fmv.x.w a6, ft3
+	fnmsub.s ft3, ft0, ft1, ft2
+	fmv.x.w t1, ft3
+	fnmadd.s ft3, ft0, ft1, ft2
+	fmv.x.w s0, ft3
+	fsflags s1, zero
+	fcvt.w.s s2, ft3
+	fcvt.s.w ft4, s2
+	fmv.x.w s3, ft4
+	li t0, -1
+	fcvt.s.wu ft4, t0
+	fmv.x.w s4, ft4
+	fcvt.s.w ft4, t0
+	fmv.x.w s5, ft4
+	li t0, 0x3f800002
+	fmv.w.x ft5, t0
+	li t0, 0x3f800000
+	fmv.w.x ft6, t0
+	fmsub.s ft7, ft5, ft5, ft6
+	fmv.x.w s6, ft7
+	fmul.s ft7, ft5, ft5
+	fsub.s ft7, ft7, ft6
+	fmv.x.w s7, ft7
+	addi sp, sp, -16
+	fsw ft3, 0(sp)
+	lw s8, 0(sp)
+	sw t0, 4(sp)
+	flw fs0, 4(sp)
+	fadd.s fs0, fs0, fs0
+	fmv.x.w s9, fs0
+	addi sp, sp, 16
+	frflags s10
+	li t0, 0
+	li a7, 10
+	ecall
@@ -0,0 +1,17 @@
+	.text
+	li t0, 0x40490fdb
+	addi sp, sp, -16
+	sw t0, 8(sp)
+	flw fa0, 8(sp)
+	fsw fa0, 12(sp)
+	lw a1, 12(sp)
+	addi s0, sp, 0
+	flw fa1, 8(s0)
+	fadd.s fa1, fa1, fa0
+	fsw fa1, 4(s0)
+	lw a2, 4(s0)
+	addi sp, sp, 16
+	li s0, 0
+	li t0, 0
+	li a7, 10
+	ecall
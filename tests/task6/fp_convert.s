@@ -0,0 +1,55 @@
+	.text
+	li t0, 0x4f32d05e
+	fmv.w.x ft0, t0
+	fcvt.w.s a0, ft0
+	fsflags a1, zero
+	li t0, 0xff800000
+	fmv.w.x ft1, t0
+	fcvt.w.s a2, ft1
+	li t0, 0x7fc00000
+	fmv.w.x ft2, t0
+	fcvt.w.s a3, ft2
+	fcvt.wu.s a4, ft2
+	fsflags a5, zero
+	li t0, 0xbf800000
+	fmv.w.x ft3, t0
+	fcvt.wu.s a6, ft3
+	fsflags ra, zero
+	li t0, 0xbecccccd
+	fmv.w.x ft4, t0
+	fcvt.wu.s s0, ft4
+	fsflags s1, zero
+	fcvt.wu.s s2, ft0
+	fsflags s3, zero
+	li t0, 0x00800000
+	fmv.w.x ft5, t0
+	li t0, 0x3f000000
+	fmv.w.x ft6, t0
+	fmul.s ft7, ft5, ft6
+	fmv.x.w s4, ft7
+	fsflags s5, zero
+	li t0, 0x40400000
+	fmv.w.x ft8, t0
+	fdiv.s ft7, ft5, ft8
+	fmv.x.w s6, ft7
+	fsflags s7, zero
+	fdiv.s ft7, ft5, ft8, rmm
+	fmv.x.w s8, ft7
+	fsflags s9, zero
+	li t0, 0x7f800000
+	fmv.w.x ft9, t0
+	fmv.w.x ft10, zero
+	fmadd.s ft7, ft9, ft10, ft2
+	fmv.x.w s10, ft7
+	fsflags s11, zero
+	li t0, -7
+	fcvt.wu.s t1, ft3, rtz
+	fcvt.s.wu ft7, t0, rdn
+	fmv.x.w t2, ft7
+	li t0, 0x80000081
+	fcvt.s.wu ft7, t0, rup
+	fmv.x.w t3, ft7
+	fsflags t4, zero
+	li t0, 0
+	li a7, 10
+	ecall
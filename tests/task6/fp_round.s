@@ -0,0 +1,67 @@
+	.text
+	li t0, 0x3f800000
+	fmv.w.x ft0, t0
+	li t0, 0x40400000
+	fmv.w.x ft1, t0
+	fneg.s ft2, ft0
+	fdiv.s ft3, ft0, ft1, rne
+	fmv.x.w a0, ft3
+	fdiv.s ft3, ft0, ft1, rtz
+	fmv.x.w a1, ft3
+	fdiv.s ft3, ft0, ft1, rdn
+	fmv.x.w a2, ft3
+	fdiv.s ft3, ft0, ft1, rup
+	fmv.x.w a3, ft3
+	fdiv.s ft3, ft0, ft1, rmm
+	fmv.x.w a4, ft3
+	fdiv.s ft3, ft2, ft1, rdn
+	fmv.x.w a5, ft3
+	fdiv.s ft3, ft2, ft1, rup
+	fmv.x.w a6, ft3
+	li t0, 0x33800000
+	fmv.w.x ft4, t0
+	fadd.s ft3, ft0, ft4, rne
+	fmv.x.w s0, ft3
+	fadd.s ft3, ft0, ft4, rmm
+	fmv.x.w s1, ft3
+	fsub.s ft3, ft2, ft4, rmm
+	fmv.x.w s2, ft3
+	li t0, 0x40200000
+	fmv.w.x ft5, t0
+	fcvt.w.s s3, ft5, rne
+	fcvt.w.s s4, ft5, rmm
+	fcvt.w.s s5, ft5, rup
+	fcvt.w.s s6, ft5, rtz
+	fneg.s ft5, ft5
+	fcvt.w.s s7, ft5, rmm
+	fcvt.w.s s8, ft5, rdn
+	li t0, 16777219
+	fcvt.s.w ft6, t0, rne
+	fmv.x.w s9, ft6
+	fcvt.s.w ft6, t0, rtz
+	fmv.x.w s11, ft6
+	li t0, 16777217
+	fcvt.s.w ft6, t0, rmm
+	fmv.x.w s10, ft6
+	fsrmi t1, 3
+	fdiv.s ft3, ft0, ft1
+	fmv.x.w t2, ft3
+	fsrmi 4
+	fadd.s ft3, ft0, ft4
+	fmv.x.w t3, ft3
+	frrm t4
+	fsrm zero
+	li t0, 0x7f7fffff
+	fmv.w.x ft7, t0
+	fsflags zero
+	fadd.s ft3, ft7, ft7, rtz
+	fmv.x.w t5, ft3
+	frflags t6
+	fadd.s ft3, ft7, ft7, rmm
+	fmv.x.w t0, ft3
+	frcsr ra
+	fsflags zero
+	csrr gp, fcsr
+	fscsr tp, zero
+	li a7, 10
+	ecall
@@ -0,0 +1,69 @@
+	.text
+	fmv.w.x ft0, zero
+	li t0, 0x3f800000
+	fmv.w.x ft1, t0
+	fdiv.s ft2, ft0, ft0
+	fmv.x.w a0, ft2
+	fsflags a1, zero
+	fdiv.s ft2, ft1, ft0
+	fmv.x.w a2, ft2
+	fsflags a3, zero
+	fneg.s ft3, ft1
+	fsqrt.s ft2, ft3
+	fmv.x.w a4, ft2
+	li t0, 0x7f800001
+	fmv.w.x ft4, t0
+	li t0, 0x7fc12345
+	fmv.w.x ft5, t0
+	fsflags zero
+	fadd.s ft2, ft4, ft1
+	fmv.x.w a5, ft2
+	fsflags a6, zero
+	fmul.s ft2, ft5, ft1
+	fmv.x.w t0, ft2
+	fsflags s0, zero
+	fmin.s ft2, ft5, ft1
+	fmv.x.w s1, ft2
+	fsflags t1, zero
+	fmax.s ft2, ft4, ft3
+	fmv.x.w s2, ft2
+	fsflags t2, zero
+	fmin.s ft2, ft4, ft5
+	fmv.x.w s3, ft2
+	fneg.s ft6, ft0
+	fmax.s ft2, ft6, ft0
+	fmv.x.w s4, ft2
+	fmin.s ft2, ft0, ft6
+	fmv.x.w s5, ft2
+	fsflags zero
+	feq.s s6, ft5, ft1
+	fsflags t3, zero
+	flt.s s7, ft5, ft1
+	fsflags t4, zero
+	fle.s s8, ft1, ft1
+	flt.s s9, ft6, ft0
+	feq.s s10, ft6, ft0
+	fclass.s t5, ft3
+	fclass.s t6, ft4
+	slli t6, t6, 10
+	or t5, t5, t6
+	fclass.s t6, ft6
+	slli t6, t6, 20
+	or t5, t5, t6
+	li a7, 0x80000001
+	fmv.w.x ft7, a7
+	fclass.s s11, ft7
+	fclass.s t6, ft5
+	slli t6, t6, 10
+	or s11, s11, t6
+	fclass.s t6, ft2
+	slli t6, t6, 20
+	or s11, s11, t6
+	fsgnjx.s ft2, ft3, ft3
+	fabs.s ft7, ft3
+	fsgnjn.s ft8, ft4, ft4
+	fmv.x.w ra, ft2
+	fmv.x.w gp, ft7
+	fmv.x.w tp, ft8
+	li a7, 10
+	ecall